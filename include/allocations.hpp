@@ -0,0 +1,96 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : allocations
+ * @created     : Saturday Oct 17, 2026 18:41:17 CEST
+ * @description : heap allocations accounting per subsystem
+ * */
+
+#ifndef ALLOCATIONS_HPP
+#define ALLOCATIONS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+namespace sym::allocations
+{
+
+// Configure with -DROPES_COUNT_ALLOCATIONS=ON to replace the global operator new and count
+#ifdef ROPES_COUNT_ALLOCATIONS
+constexpr inline bool enabled = true;
+#else
+constexpr inline bool enabled = false;
+#endif
+
+enum class subsystem : std::uint8_t { other, simulation, expression, graphics };
+
+constexpr inline auto subsystems = std::array{
+    subsystem::other, subsystem::simulation, subsystem::expression, subsystem::graphics
+};
+
+constexpr auto name(subsystem s) noexcept -> std::string_view
+{
+    switch (s) {
+    case subsystem::other:      return "Other";
+    case subsystem::simulation: return "Simulation";
+    case subsystem::expression: return "Expression";
+    case subsystem::graphics:   return "Graphics";
+    }
+    return "";
+}
+
+struct counters
+{
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+
+    friend constexpr auto operator-(counters const & a, counters const & b) noexcept -> counters
+    {
+        return {a.allocations - b.allocations, a.bytes - b.bytes};
+    }
+    friend constexpr auto operator==(counters const &, counters const &) -> bool = default;
+};
+
+using snapshot_t = std::array<counters, subsystems.size()>;
+
+// the subsystem to which the allocations of the current thread are charged
+inline thread_local auto current_subsystem = subsystem::other;
+
+/**
+ * @brief Charges the allocations of the current thread to a subsystem, until destroyed
+ */
+class scope
+{
+    subsystem _previous;
+
+public:
+    explicit scope(subsystem s) noexcept : _previous{std::exchange(current_subsystem, s)} {}
+    ~scope() { current_subsystem = _previous; }
+
+    scope(scope const &) = delete;
+    scope(scope &&) = delete;
+    auto operator=(scope const &) -> scope & = delete;
+    auto operator=(scope &&) -> scope & = delete;
+};
+
+/**
+ * @brief The allocations of a subsystem since the start, summed over all the threads; always
+ * zero unless `enabled`
+ */
+auto count(subsystem s) noexcept -> counters;
+
+/** The allocations of all the subsystems */
+auto snapshot() noexcept -> snapshot_t;
+
+/**
+ * @brief Prints on stderr the allocations of each subsystem since the start, in total and per step
+ *
+ * @param steps the number of steps integrated
+ */
+void report(std::size_t steps);
+
+}  // namespace sym::allocations
+
+#endif /* ALLOCATIONS_HPP */
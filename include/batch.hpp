@@ -0,0 +1,47 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : batch
+ * @created     : Thursday Oct 22, 2026 10:05:41 CEST
+ * @description : SIMD batches of values for the expressions
+ * */
+
+#ifndef BRUN_EXPR_BATCH_HPP
+#define BRUN_EXPR_BATCH_HPP
+
+#include <expression.hpp>
+#include <experimental/simd>
+
+namespace brun::expr
+{
+
+namespace stdx = std::experimental;
+
+/**
+ * As many values as fit in a SIMD register of the target: the arithmetic operators are single
+ * instructions, the functions of <cmath> are provided by <experimental/simd>, lane by lane.
+ */
+using batch = stdx::native_simd<const_t>;
+
+/** The `%` of the expressions, lane by lane */
+inline auto modulus(batch const & a, batch const & b) -> batch
+{
+    return batch{[&](auto i) { return static_cast<const_t>(static_cast<long>(a[i]) % static_cast<long>(b[i])); }};
+}
+
+/** -1, 0 or 1, lane by lane */
+inline auto sign(batch const & a) -> batch
+{
+    auto result = batch{0.};
+    stdx::where(a > 0., result) = 1.;
+    stdx::where(a < 0., result) = -1.;
+    return result;
+}
+
+inline auto is_zero(batch const & a) -> bool { return stdx::all_of(a == 0.); }
+
+/** The slope of a step function taking the values `step`: zero, as almost everywhere */
+inline auto step_slope([[maybe_unused]] batch const & step) -> batch { return batch{0.}; }
+
+}  // namespace brun::expr
+
+#endif /* BRUN_EXPR_BATCH_HPP */
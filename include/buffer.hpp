@@ -0,0 +1,141 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : buffer
+ * @created     : Saturday Oct 17, 2026 17:12:48 CEST
+ * @description : large arrays backed by huge pages and first touched by the workers
+ * */
+
+#ifndef BUFFER_HPP
+#define BUFFER_HPP
+
+#include <scheduler.hpp>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace sym
+{
+
+namespace memory
+{
+/**
+ * Size of the transparent huge pages; allocations of at least this size are aligned to it and, if
+ * `use_huge_pages` is set, advised to be backed by huge pages
+ */
+constexpr inline auto huge_page_size = std::size_t{2} << 20;
+
+/** Whether the big buffers should be backed by huge pages; set it before creating them */
+extern bool use_huge_pages;
+
+/** Allocates `bytes` aligned to `alignment`, or to a huge page if the allocation is big enough */
+auto allocate(std::size_t bytes, std::size_t alignment) -> void *;
+
+/** Frees the memory returned by `allocate` with the same arguments */
+void release(void * ptr, std::size_t bytes, std::size_t alignment) noexcept;
+
+/**
+ * The number of elements of `size` bytes in each chunk that first touches `bytes` of memory: whole
+ * huge pages if they are used, otherwise the chunks of the parallel loops
+ */
+auto first_touch_grain(std::size_t bytes, std::size_t size) noexcept -> std::ptrdiff_t;
+
+/** Zeroes a big allocation in chunks of the workers, which places each page near its worker */
+void first_touch(void * ptr, std::size_t bytes, std::size_t size, sym::scheduler & pool = sym::scheduler::global());
+
+/**
+ * @brief Allocator of the vectors that the steps swap with their own results, like the rope: the
+ * pages are first touched by the workers before the vector constructs the elements on its thread
+ */
+template <typename T>
+struct allocator
+{
+    using value_type = T;
+    static constexpr auto alignment = std::max(alignof(T), std::size_t{64});
+
+    allocator() = default;
+    template <typename U>
+    constexpr allocator(allocator<U> const &) noexcept {}  // NOLINT(*-explicit-*)
+
+    [[nodiscard]] auto allocate(std::size_t n) -> T *
+    {
+        auto * const ptr = memory::allocate(n * sizeof(T), alignment);
+        memory::first_touch(ptr, n * sizeof(T), sizeof(T));
+        return static_cast<T *>(ptr);
+    }
+
+    void deallocate(T * ptr, std::size_t n) noexcept { memory::release(ptr, n * sizeof(T), alignment); }
+
+    friend constexpr auto operator==(allocator const &, allocator const &) noexcept -> bool { return true; }
+};
+
+template <typename T>
+using vector = std::vector<T, allocator<T>>;
+}  // namespace memory
+
+/**
+ * @brief A fixed size array for the per-point data of big ropes; it converts to `std::span` as a
+ * contiguous range
+ *
+ * The elements are constructed with the same chunks of the parallel loops over the rope, by the
+ * same workers: on Linux a page is placed on the NUMA node of the thread that first writes it, so
+ * each worker later finds its chunks in local memory.
+ */
+template <typename T>
+class buffer
+{
+    static constexpr auto alignment = std::max(alignof(T), std::size_t{64});
+
+    T * _data = nullptr;
+    std::size_t _size = 0;
+
+public:
+    buffer() = default;
+
+    explicit buffer(std::size_t size, sym::scheduler & pool = sym::scheduler::global())
+        : _data{static_cast<T *>(memory::allocate(size * sizeof(T), alignment))}, _size{size}
+    {
+        auto const grain = memory::first_touch_grain(size * sizeof(T), sizeof(T));
+        pool.parallel_for(0, std::ssize(*this), grain, [this](auto first, auto last) {
+            std::uninitialized_value_construct(_data + first, _data + last);
+        });
+    }
+
+    ~buffer()
+    {
+        if (_data != nullptr) {
+            std::destroy_n(_data, _size);
+            memory::release(_data, _size * sizeof(T), alignment);
+        }
+    }
+
+    buffer(buffer const &) = delete;
+    auto operator=(buffer const &) -> buffer & = delete;
+
+    buffer(buffer && other) noexcept
+        : _data{std::exchange(other._data, nullptr)}, _size{std::exchange(other._size, 0)}
+    {}
+
+    auto operator=(buffer && other) noexcept -> buffer &
+    {
+        auto tmp = std::move(other);
+        std::swap(_data, tmp._data);
+        std::swap(_size, tmp._size);
+        return *this;
+    }
+
+    [[nodiscard]] auto size() const noexcept { return _size; }
+    [[nodiscard]] auto empty() const noexcept { return _size == 0; }
+    [[nodiscard]] auto data() noexcept -> T * { return _data; }
+    [[nodiscard]] auto data() const noexcept -> T const * { return _data; }
+    [[nodiscard]] auto begin() noexcept -> T * { return _data; }
+    [[nodiscard]] auto begin() const noexcept -> T const * { return _data; }
+    [[nodiscard]] auto end() noexcept -> T * { return _data + _size; }
+    [[nodiscard]] auto end() const noexcept -> T const * { return _data + _size; }
+    [[nodiscard]] auto operator[](std::size_t idx) noexcept -> T & { return _data[idx]; }
+    [[nodiscard]] auto operator[](std::size_t idx) const noexcept -> T const & { return _data[idx]; }
+};
+
+}  // namespace sym
+
+#endif /* BUFFER_HPP */
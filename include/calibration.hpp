@@ -0,0 +1,75 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : calibration
+ * @created     : Friday Oct 23, 2026 10:12:47 CEST
+ * @description : fit of the constants of the rope to a recorded trajectory
+ * */
+
+#ifndef CALIBRATION_HPP
+#define CALIBRATION_HPP
+
+#include <simulation.hpp>
+#include <trajectory.hpp>
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+
+namespace sym
+{
+
+struct calibration_options
+{
+    enum parameter : std::uint8_t {
+        elastic_constant = 1U << 0U,
+        young_modulus = 1U << 1U,
+        external_damping = 1U << 2U,
+        internal_damping = 1U << 3U
+    };
+
+    std::uint8_t parameters = elastic_constant | young_modulus | external_damping | internal_damping;
+    int samples = 100;  // frames of the reference compared with the simulation, evenly spaced
+    int max_evaluations = 400;  // simulations, aborted ones included
+    double tolerance = 1e-3;  // on the spread of the losses of the simplex, relative to the best one
+    double initial_step = 0.2;  // of the logarithm of each parameter, for the first simplex
+};
+
+struct calibration_result
+{
+    sym::settings settings;  // with the fitted parameters
+    ph::length loss;  // the RMS distance of the points from the reference, over the samples
+    int evaluations = 0;
+    int aborted = 0;  // simulations stopped once clearly worse than the current candidates
+    bool converged = false;
+};
+
+/**
+ * @brief Fits the selected constants of the rope so that its motion follows a recorded trajectory
+ *
+ * Each candidate is simulated from the first frame of the reference, with the velocities of the
+ * difference between the first two frames, and scored by the RMS distance of its points from the
+ * reference at the sampled frames. The logarithms of the parameters are minimized with the
+ * Nelder-Mead method: every iteration simulates the reflection, the expansion and the two
+ * contractions of the worst vertex in parallel on the scheduler, even if only some of them will
+ * be used, and stops each simulation as soon as its partial loss exceeds the one of the worst
+ * vertex, which it could not replace anymore. The candidates that diverge at `settings.dt` are
+ * discarded in the same way.
+ *
+ * @param settings the settings from the CLI and UI, the initial guess of the parameters; the other
+ * constants and the fixed points are the ones of the simulation
+ * @param reference a trajectory of a rope with `settings.number_of_points` points
+ * @param options the parameters to fit, the samples and the stopping criterion
+ * @throw std::invalid_argument if the reference does not match the settings, or a parameter to fit
+ * is not positive
+ */
+auto calibrate(
+    sym::settings const & settings, sym::trajectory_reader & reference,
+    sym::calibration_options const & options = {}
+) -> sym::calibration_result;
+
+/** Parses a comma separated list of parameters among "k", "E", "b" and "c" */
+auto parse_calibrated_parameters(std::string_view names) -> std::expected<std::uint8_t, std::string>;
+
+}  // namespace sym
+
+#endif /* CALIBRATION_HPP */
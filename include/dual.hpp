@@ -0,0 +1,261 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : dual
+ * @created     : Thursday Oct 22, 2026 09:17:03 CEST
+ * @description : dual numbers, for the forward mode automatic differentiation of the expressions
+ * */
+
+#ifndef BRUN_EXPR_DUAL_HPP
+#define BRUN_EXPR_DUAL_HPP
+
+#include <expression.hpp>
+#include <batch.hpp>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+namespace brun::expr
+{
+
+/** The `%` of the expressions */
+constexpr auto modulus(const_t a, const_t b) -> const_t
+{
+    return static_cast<const_t>(static_cast<long>(a) % static_cast<long>(b));
+}
+
+constexpr auto sign(const_t a) noexcept -> const_t { return a > 0. ? 1. : a < 0. ? -1. : 0.; }
+constexpr auto is_zero(const_t a) noexcept { return a == 0.; }
+constexpr auto step_slope([[maybe_unused]] const_t step) noexcept -> const_t { return 0.; }
+
+namespace detail
+{
+template <typename T, std::size_t N>
+constexpr auto filled(T const & value) -> std::array<T, N>
+{
+    return [&]<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<T, N>{(static_cast<void>(I), value)...};
+    }(std::make_index_sequence<N>{});
+}
+}  // namespace detail
+
+/**
+ * @brief A value and its derivatives with respect to `N` variables
+ *
+ * Evaluating an expression on duals (`evaluate`, `static_expression`) gives its value and its
+ * gradient in a single pass, each operation applying the chain rule, at about twice the cost of
+ * the value alone. `T` may be `const_t`, a `batch` of values or an `interval`, for the bounds of
+ * the derivatives over an interval of the variables. At the points where a function is not
+ * differentiable the derivative is one of the one-sided ones, or zero for `abs`; the `%`, being
+ * constant almost everywhere, has zero derivatives but where its intervals jump.
+ */
+template <typename T = const_t, std::size_t N = 1>
+struct dual
+{
+    T value;
+    std::array<T, N> gradient;
+
+    constexpr dual(const_t constant) : value{constant}, gradient{detail::filled<T, N>(T{0.})} {}  // NOLINT: a constant of the expressions
+    constexpr dual(T value, std::array<T, N> const & gradient) : value{std::move(value)}, gradient{gradient} {}
+
+    /** The `index`-th variable, of derivative 1 with respect to itself */
+    static constexpr auto variable(T value, std::size_t index = 0) -> dual
+    {
+        auto gradient = detail::filled<T, N>(T{0.});
+        gradient[index] = T{1.};
+        return {std::move(value), gradient};
+    }
+
+    [[nodiscard]] constexpr auto derivative() const -> T const & requires (N == 1) { return gradient[0]; }
+};
+
+namespace detail
+{
+// the dual of a function with value `value` and derivative `slope` at `a`
+template <typename T, std::size_t N>
+constexpr auto chain(dual<T, N> const & a, T value, T const & slope) -> dual<T, N>
+{
+    auto result = dual<T, N>{std::move(value), a.gradient};
+    for (auto & d : result.gradient) {
+        d = d * slope;
+    }
+    return result;
+}
+
+template <typename T, std::size_t N>
+constexpr auto is_constant(dual<T, N> const & a)
+{
+    for (auto const & d : a.gradient) {
+        if (not is_zero(d)) {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace detail
+
+template <typename T, std::size_t N>
+constexpr auto operator+(dual<T, N> const & a, dual<T, N> const & b) -> dual<T, N>
+{
+    auto result = dual<T, N>{a.value + b.value, a.gradient};
+    for (auto i = 0uz; i < N; ++i) {
+        result.gradient[i] = a.gradient[i] + b.gradient[i];
+    }
+    return result;
+}
+
+template <typename T, std::size_t N>
+constexpr auto operator-(dual<T, N> const & a, dual<T, N> const & b) -> dual<T, N>
+{
+    auto result = dual<T, N>{a.value - b.value, a.gradient};
+    for (auto i = 0uz; i < N; ++i) {
+        result.gradient[i] = a.gradient[i] - b.gradient[i];
+    }
+    return result;
+}
+
+template <typename T, std::size_t N>
+constexpr auto operator*(dual<T, N> const & a, dual<T, N> const & b) -> dual<T, N>
+{
+    auto result = dual<T, N>{a.value * b.value, a.gradient};
+    for (auto i = 0uz; i < N; ++i) {
+        result.gradient[i] = a.gradient[i] * b.value + a.value * b.gradient[i];
+    }
+    return result;
+}
+
+template <typename T, std::size_t N>
+constexpr auto operator/(dual<T, N> const & a, dual<T, N> const & b) -> dual<T, N>
+{
+    auto result = dual<T, N>{a.value / b.value, a.gradient};
+    for (auto i = 0uz; i < N; ++i) {
+        result.gradient[i] = (a.gradient[i] - result.value * b.gradient[i]) / b.value;
+    }
+    return result;
+}
+
+template <typename T, std::size_t N>
+constexpr auto operator-(dual<T, N> const & a) -> dual<T, N>
+{
+    auto result = dual<T, N>{-a.value, a.gradient};
+    for (auto & d : result.gradient) {
+        d = -d;
+    }
+    return result;
+}
+
+template <typename T, std::size_t N>
+constexpr auto sin(dual<T, N> const & a) -> dual<T, N>
+{
+    using std::sin, std::cos;
+    return detail::chain(a, sin(a.value), cos(a.value));
+}
+
+template <typename T, std::size_t N>
+constexpr auto cos(dual<T, N> const & a) -> dual<T, N>
+{
+    using std::sin, std::cos;
+    return detail::chain(a, cos(a.value), -sin(a.value));
+}
+
+template <typename T, std::size_t N>
+constexpr auto tan(dual<T, N> const & a) -> dual<T, N>
+{
+    using std::tan;
+    auto value = tan(a.value);
+    auto const slope = T{1.} + value * value;
+    return detail::chain(a, std::move(value), slope);
+}
+
+template <typename T, std::size_t N>
+constexpr auto asin(dual<T, N> const & a) -> dual<T, N>
+{
+    using std::asin, std::sqrt;
+    return detail::chain(a, asin(a.value), T{1.} / sqrt(T{1.} - a.value * a.value));
+}
+
+template <typename T, std::size_t N>
+constexpr auto acos(dual<T, N> const & a) -> dual<T, N>
+{
+    using std::acos, std::sqrt;
+    return detail::chain(a, acos(a.value), T{-1.} / sqrt(T{1.} - a.value * a.value));
+}
+
+template <typename T, std::size_t N>
+constexpr auto atan(dual<T, N> const & a) -> dual<T, N>
+{
+    using std::atan;
+    return detail::chain(a, atan(a.value), T{1.} / (T{1.} + a.value * a.value));
+}
+
+template <typename T, std::size_t N>
+constexpr auto exp(dual<T, N> const & a) -> dual<T, N>
+{
+    using std::exp;
+    auto value = exp(a.value);
+    auto const slope = value;
+    return detail::chain(a, std::move(value), slope);
+}
+
+template <typename T, std::size_t N>
+constexpr auto log(dual<T, N> const & a) -> dual<T, N>
+{
+    using std::log;
+    return detail::chain(a, log(a.value), T{1.} / a.value);
+}
+
+template <typename T, std::size_t N>
+constexpr auto sqrt(dual<T, N> const & a) -> dual<T, N>
+{
+    using std::sqrt;
+    auto value = sqrt(a.value);
+    auto const slope = T{0.5} / value;
+    return detail::chain(a, std::move(value), slope);
+}
+
+template <typename T, std::size_t N>
+constexpr auto cbrt(dual<T, N> const & a) -> dual<T, N>
+{
+    using std::cbrt;
+    auto value = cbrt(a.value);
+    auto const slope = T{1.} / (T{3.} * value * value);
+    return detail::chain(a, std::move(value), slope);
+}
+
+template <typename T, std::size_t N>
+constexpr auto abs(dual<T, N> const & a) -> dual<T, N>
+{
+    using std::abs;
+    return detail::chain(a, abs(a.value), sign(a.value));
+}
+
+template <typename T, std::size_t N>
+constexpr auto pow(dual<T, N> const & a, dual<T, N> const & b) -> dual<T, N>
+{
+    using std::pow, std::log;
+    auto result = detail::chain(a, pow(a.value, b.value), b.value * pow(a.value, b.value - T{1.}));
+    // the usual constant exponent would give 0 * log(a), which is NaN for the negative bases
+    if (not detail::is_constant(b)) {
+        auto const slope = result.value * log(a.value);
+        for (auto i = 0uz; i < N; ++i) {
+            result.gradient[i] = result.gradient[i] + slope * b.gradient[i];
+        }
+    }
+    return result;
+}
+
+template <typename T, std::size_t N>
+constexpr auto modulus(dual<T, N> const & a, dual<T, N> const & b) -> dual<T, N>
+{
+    auto value = modulus(a.value, b.value);
+    auto const slope = step_slope(value);
+    auto result = dual<T, N>{std::move(value), a.gradient};
+    for (auto i = 0uz; i < N; ++i) {
+        result.gradient[i] = slope * (a.gradient[i] + b.gradient[i]);
+    }
+    return result;
+}
+
+}  // namespace brun::expr
+
+#endif /* BRUN_EXPR_DUAL_HPP */
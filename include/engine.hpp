@@ -0,0 +1,97 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : engine
+ * @created     : Sunday Oct 18, 2026 11:05:19 CEST
+ * @description : embeddable interface to the simulation
+ * */
+
+#ifndef ENGINE_HPP
+#define ENGINE_HPP
+
+#include <simulation.hpp>
+#include <ranges>
+
+namespace sym
+{
+
+/**
+ * @brief A rope with its settings, to drive the simulation from another program.
+ *
+ * The engine owns the state and exposes it through views, which stay valid until the next call
+ * to a non-const member function. Steps are guarded by a `sym::watchdog` and, once the buffers are
+ * warm, do not allocate.
+ */
+class engine
+{
+    sym::settings _settings;
+    sym::memory::vector<ph::state> _rope;
+    sym::memory::vector<ph::metadata> _metadata;
+    ph::simulation_data _next;  // swapped with the rope after each step
+    sym::watchdog _watchdog;
+    ph::time _t;
+    bool _save_metadata;
+
+public:
+    /**
+     * @brief Builds the rope from the formulas or from the shape file of the settings
+     *
+     * @param settings the settings of the simulation
+     * @param save_metadata whether to compute the forces on each point at each step
+     * @throw std::invalid_argument if a formula cannot be parsed
+     */
+    explicit engine(sym::settings settings, bool save_metadata = false);
+
+    /**
+     * @brief Starts from a given rope
+     *
+     * @throw std::invalid_argument if the rope is empty
+     */
+    engine(sym::settings settings, std::span<ph::state const> rope, bool save_metadata = false);
+
+    /**
+     * Integrates `n` time-steps of `settings().dt`, which the watchdog may reduce; stops early,
+     * leaving the rope and the time unchanged, at a step the watchdog cannot make stable
+     */
+    void step(int n = 1);
+
+    /**
+     * @brief Replaces the settings, keeping the current state: the constants, the forces enabled
+     * and the time-step apply from the next step. Call `reset` to rebuild the rope for new formulas,
+     * number of points or length.
+     */
+    void update(sym::settings const & settings);
+
+    /**
+     * @brief Rebuilds the rope from the settings and restarts the time
+     *
+     * @throw std::invalid_argument if a formula cannot be parsed
+     * @throw std::runtime_error if the shape file cannot be read
+     */
+    void reset();
+
+    [[nodiscard]] auto settings() const noexcept -> sym::settings const & { return _settings; }
+    [[nodiscard]] auto time() const noexcept { return _t; }
+    [[nodiscard]] auto watchdog() const noexcept -> sym::watchdog const & { return _watchdog; }
+
+    /** The points of the rope */
+    [[nodiscard]] auto states() const noexcept -> std::span<ph::state const> { return _rope; }
+
+    /** The forces on each point after the last step; empty unless the engine saves the metadata */
+    [[nodiscard]] auto metadata() const noexcept -> std::span<ph::metadata const> { return _metadata; }
+
+    /** The positions of the points, as a random access view over `states()` */
+    [[nodiscard]] auto positions() const noexcept
+    {
+        return states() | std::views::transform(&ph::state::x);
+    }
+
+    /** The velocities of the points, as a random access view over `states()` */
+    [[nodiscard]] auto velocities() const noexcept
+    {
+        return states() | std::views::transform(&ph::state::v);
+    }
+};
+
+}  // namespace sym
+
+#endif /* ENGINE_HPP */
@@ -0,0 +1,104 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : ensemble
+ * @created     : Saturday Oct 17, 2026 15:04:26 CEST
+ * @description : batched stepping of many ropes in SIMD lanes
+ * */
+
+#ifndef ENSEMBLE_HPP
+#define ENSEMBLE_HPP
+
+#include <simulation.hpp>
+#include <array>
+
+namespace sym
+{
+
+/**
+ * @brief Steps many ropes with the same number of points at once, with RK4.
+ *
+ * The ropes are grouped in blocks of `width` ropes, and each quantity of a point is stored as
+ * `width` contiguous values, one per rope of the block (array of structures of arrays): the
+ * kernel then advances all the ropes of a block with the same vector instructions.
+ * Each rope keeps its own constants and forces enabled. Metadata is not computed.
+ */
+class ensemble
+{
+public:
+    static constexpr auto width = std::size_t{4};
+    using lanes = std::array<double, width>;
+
+    /** The state of a point, or its derivative, for all the ropes of a block - in SI units */
+    struct alignas(sizeof(lanes)) point
+    {
+        lanes x;
+        lanes y;
+        lanes vx;
+        lanes vy;
+    };
+
+private:
+    struct alignas(sizeof(lanes)) segment
+    {
+        lanes tx;  // unit direction
+        lanes ty;
+        lanes length;
+        lanes fx;  // force on the first endpoint
+        lanes fy;
+    };
+
+    struct block
+    {
+        // constants of each rope, in SI units; zero if the force is disabled
+        lanes k;
+        lanes b;
+        lanes c;
+        lanes EI;
+        lanes g;
+        lanes l;
+        std::vector<lanes> m;  // the mass of each point
+        std::vector<lanes> free;  // 1 for the free points, 0 for the fixed ones
+        std::vector<point> state;
+
+        // scratch buffers
+        std::vector<point> stage;
+        std::array<std::vector<point>, 4> derivatives;
+        std::vector<segment> segments;
+    };
+
+    std::ptrdiff_t _n_points;
+    std::size_t _n_ropes;
+    std::vector<block> _blocks;
+
+    static void evaluate(block & blk, std::span<point const> states, std::span<point> out) noexcept;
+    static void step(block & blk, double dt) noexcept;
+
+public:
+    /**
+     * @brief Builds the ensemble
+     *
+     * @param settings the settings of each rope
+     * @param ropes the initial state of each rope; all the ropes must have the same size
+     * @throw std::invalid_argument if the sizes do not match
+     */
+    ensemble(std::span<sym::settings const> settings, std::span<std::vector<ph::state> const> ropes);
+
+    /**
+     * @brief Advances all the ropes of a time-step
+     */
+    void step(ph::duration dt);
+
+    /** The number of ropes */
+    [[nodiscard]] auto size() const noexcept { return _n_ropes; }
+
+    /**
+     * @brief Extracts the current state of a rope
+     *
+     * @param idx the index of the rope, in the order given to the constructor
+     */
+    [[nodiscard]] auto rope(std::size_t idx) const -> std::vector<ph::state>;
+};
+
+}  // namespace sym
+
+#endif /* ENSEMBLE_HPP */
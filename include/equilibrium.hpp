@@ -0,0 +1,66 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : equilibrium
+ * @created     : Saturday Oct 17, 2026 10:31:05 CEST
+ * @description : static equilibrium of the rope and linearization of the forces
+ * */
+
+#ifndef EQUILIBRIUM_HPP
+#define EQUILIBRIUM_HPP
+
+#include <simulation.hpp>
+
+namespace sym
+{
+
+/**
+ * @brief Computes the jacobian of the accelerations with respect to the positions, by central
+ * finite differences. Each point only interacts with its first neighbours, so the matrix is
+ * block tridiagonal; the columns of points three indices apart are computed together.
+ *
+ * The unknowns are ordered as (x₀, y₀, x₁, y₁, ...) and expressed in m, the accelerations
+ * in m/s². The columns of the fixed points are left empty.
+ *
+ * @param settings the settings from the CLI and UI
+ * @param states the state to linearize around
+ */
+auto acceleration_jacobian(
+    sym::settings const & settings, std::span<ph::state const> states
+) -> math::banded_matrix<double>;
+
+/**
+ * @brief Points equally spaced along the catenary of a rope of given length hanging between
+ * two points, or along the segment joining them if the rope is too short to sag.
+ * The positions are in the simulation frame, where the y axis points downwards.
+ *
+ * @param from the first end of the rope
+ * @param to the last end of the rope
+ * @param length the length of the rope
+ * @param n_points the number of points to generate
+ */
+auto catenary(
+    ph::vector<> const & from, ph::vector<> const & to, double length, std::ptrdiff_t n_points
+) -> std::vector<ph::vector<>>;
+
+/**
+ * @brief Finds the static equilibrium of the rope under the forces enabled in the settings,
+ * keeping its fixed points where they are.
+ *
+ * The initial guess is a catenary if both ends are fixed, the rope hanging straight down if
+ * only one point is fixed, or the given shape otherwise; it is then refined with a damped
+ * Newton iteration on the banded stiffness system.
+ *
+ * @param settings the settings from the CLI and UI
+ * @param rope the rope to bring at rest
+ * @param max_iterations the maximum number of Newton iterations
+ * @param tolerance the maximum residual acceleration, relative to the standard gravity
+ * @return the rope at rest; if the iteration does not converge, the best state found
+ */
+auto static_equilibrium(
+    sym::settings const & settings, std::span<ph::state const> rope,
+    int max_iterations = 50, double tolerance = 1e-9
+) -> std::vector<ph::state>;
+
+}  // namespace sym
+
+#endif /* EQUILIBRIUM_HPP */
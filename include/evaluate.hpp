@@ -0,0 +1,121 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : evaluate
+ * @created     : Wednesday Oct 21, 2026 15:26:33 CEST
+ * @description : evaluation of the expressions on other number types
+ * */
+
+#ifndef BRUN_EXPR_EVALUATE_HPP
+#define BRUN_EXPR_EVALUATE_HPP
+
+#include <expression.hpp>
+#include <dual.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace brun::expr
+{
+
+/**
+ * Applies the unary function `op`, as in `node::op`, to a number type constructible from `const_t`
+ * with the arithmetic operators and with the functions of <cmath> found by ADL, like `interval`,
+ * `batch` or `dual`.
+ * With `const_t` the results are those of `expression::eval`.
+ */
+template <typename T>
+constexpr auto apply(char op, T const & a) -> T
+{
+    using std::sin, std::cos, std::tan, std::asin, std::acos, std::atan;
+    using std::exp, std::log, std::abs, std::sqrt, std::cbrt;
+    switch (op) {
+        case 's': return sin(a);
+        case 'c': return cos(a);
+        case 't': return tan(a);
+        case 'S': return asin(a);
+        case 'C': return acos(a);
+        case 'T': return atan(a);
+        case 'l': return log(a);
+        case 'e': return exp(a);
+        case '|': return abs(a);
+        case 'v': return sqrt(a);
+        case 'V': return cbrt(a);
+        case 'n': return -a;
+        default: throw std::logic_error{"Found bad operator with no correspective function"};
+    }
+}
+
+/** Applies the binary operator `op`, as `apply(op, a)` */
+template <typename T>
+constexpr auto apply(char op, T const & a, T const & b) -> T
+{
+    using std::pow;
+    switch (op) {
+        case '+': return a + b;
+        case '-': return a - b;
+        case '*': return a * b;
+        case '/': return a / b;
+        case '^': return pow(a, b);
+        case '%': return modulus(a, b);
+        default: throw std::logic_error{"Found bad operator with no correspective function"};
+    }
+}
+
+/** Evaluates a tree for the values of the parameters `params` on another number type, as `apply` */
+template <typename T, std::size_t N>
+auto evaluate(node const & n, std::array<param_t, N> const & params, std::array<T, N> const & values) -> T  // NOLINT(misc-no-recursion)
+{
+    if (auto const * constant = std::get_if<const_t>(&n.content)) {
+        return T{*constant};
+    }
+    if (auto const * p = std::get_if<param_t>(&n.content)) {
+        auto const it = std::ranges::find(params, *p);
+        if (it == params.end()) {
+            throw std::logic_error{"Wrong parameter name"};
+        }
+        return values[static_cast<std::size_t>(it - params.begin())];
+    }
+    if (std::holds_alternative<binary_f>(n.content)) {
+        return apply(n.op, evaluate(*n.left, params, values), evaluate(*n.right, params, values));
+    }
+    if (std::holds_alternative<unary_f>(n.content)) {
+        return apply(n.op, evaluate(*n.left, params, values));
+    }
+    throw std::logic_error{"Found (literally) nothing..."};
+}
+
+template <typename T, std::size_t N>
+auto evaluate(expression const & expr, std::array<param_t, N> const & params, std::array<T, N> const & values) -> T
+{
+    return evaluate(*expr.root(), params, values);
+}
+
+template <typename T>
+auto evaluate(expression const & expr, param_t param, T const & value) -> T
+{
+    return evaluate(*expr.root(), std::array{param}, std::array{value});
+}
+
+/**
+ * @brief The value of an expression and its derivatives with respect to its parameters, in a
+ * single pass on dual numbers
+ * @code
+ * auto const f = parse_expression("k*x^2", "kx");
+ * auto const [value, slopes] = gradient(*f, std::array{'k', 'x'}, std::array{2., 3.});  // 18, {9, 12}
+ * @endcode
+ */
+template <std::size_t N>
+auto gradient(expression const & expr, std::array<param_t, N> const & params, std::array<const_t, N> const & values)
+    -> dual<const_t, N>
+{
+    auto const variables = [&]<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array{dual<const_t, N>::variable(values[I], I)...};
+    }(std::make_index_sequence<N>{});
+    return evaluate(expr, params, variables);
+}
+
+}  // namespace brun::expr
+
+#endif /* BRUN_EXPR_EVALUATE_HPP */
@@ -10,6 +10,7 @@
 
 #include <fmt/core.h>
 #include <memory>
+#include <optional>
 #include <variant>
 #include <expected>
 #include <functional>
@@ -45,6 +46,7 @@ struct node
     explicit node(T && src) : content{std::forward<T>(src)} {}
 
     variant_t content;
+    char op = '\0';  // the operator or the function of the function nodes, as in `parser::ir_node`
     std::unique_ptr<node> left;
     std::unique_ptr<node> right;
 };
@@ -66,6 +68,9 @@ public:
     }
 
     explicit operator bool() const { return _head != nullptr; }
+
+    /** The root of the tree, whose nodes are constants, parameters or functions of their children */
+    [[nodiscard]] auto root() const noexcept -> node const * { return _head.get(); }
 };
 
 } // namespace brun::expr
@@ -18,6 +18,8 @@
 
 #include <math.hpp>
 #include <physics.hpp>
+#include <allocations.hpp>
+#include <modal.hpp>
 
 namespace sym { struct settings; }
 
@@ -87,27 +89,29 @@ struct forces_ui_fn {
 struct data_ui_fn {
     sym::settings const * settings;
     screen_config const * screen_cfg;
-    std::vector<ph::state> const * rope;
+    sym::memory::vector<ph::state> const * rope;
     ph::time t;
     int steps;
+    sym::allocations::snapshot_t const * allocations;  // in the last frame
 
     explicit data_ui_fn(
         sym::settings const & s,
         gfx::screen_config const & sc,
-        std::vector<ph::state> const & rope,
+        sym::memory::vector<ph::state> const & rope,
         ph::time t,
-        int steps
+        int steps,
+        sym::allocations::snapshot_t const & allocations
     ) :
         settings{std::addressof(s)}, screen_cfg{std::addressof(sc)},
-        rope{std::addressof(rope)}, t{t}, steps{steps}
+        rope{std::addressof(rope)}, t{t}, steps{steps}, allocations{std::addressof(allocations)}
     {}
     void operator()() const noexcept;
 };
 
 struct rope_editor_fn {
     sym::settings * settings;
-    std::vector<ph::state> * rope;
-    std::vector<ph::metadata> * metadata;
+    sym::memory::vector<ph::state> * rope;
+    sym::memory::vector<ph::metadata> * metadata;
     ph::duration * t;
 
     explicit rope_editor_fn(
@@ -122,6 +126,13 @@ struct rope_editor_fn {
     void operator()() noexcept;
 };
 
+struct profiler_ui_fn {
+    std::size_t points;
+    std::size_t steps;  // since the start
+
+    void operator()() const noexcept;
+};
+
 struct arrows_ui {
     std::variant<std::monostate, uint32_t, float> stride = uint32_t{10};
     std::vector<arrow_settings> arrows;
@@ -131,6 +142,32 @@ struct arrows_ui {
     void operator()() noexcept;
 };
 
+struct modes_ui {
+    sym::settings const * settings;
+    sym::memory::vector<ph::state> const * rope;
+    int count = 6;
+    bool at_equilibrium = true;  // linearize around the static equilibrium instead of the current rope
+    float amplitude = 0.05f;  // of the largest displacement, relative to the length of the rope
+    int selected = -1;  // the mode shown in the canvas, if any
+    std::vector<ph::position> base;  // the rope the modes were computed around
+    std::vector<sym::mode> modes;
+    std::string error;
+    std::vector<ph::position> frame;
+
+    explicit modes_ui(sym::settings const & settings, sym::memory::vector<ph::state> const & rope) :
+        settings{std::addressof(settings)},
+        rope{std::addressof(rope)}
+    {}
+
+    void compute() noexcept;
+    void operator()() noexcept;
+
+    [[nodiscard]] auto showing() const noexcept { return selected >= 0; }
+
+    /** The rope moving along the selected mode at `time` seconds, one period per second */
+    [[nodiscard]] auto animated(double time) -> std::vector<ph::position> const &;
+};
+
 
 [[nodiscard]]
 auto setup_SDL(int screen_width, int screen_height) -> SDL_stuff;
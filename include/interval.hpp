@@ -0,0 +1,83 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : interval
+ * @created     : Wednesday Oct 21, 2026 14:12:50 CEST
+ * @description : interval arithmetic for the expressions
+ * */
+
+#ifndef BRUN_EXPR_INTERVAL_HPP
+#define BRUN_EXPR_INTERVAL_HPP
+
+#include <expression.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace brun::expr
+{
+
+/**
+ * @brief A closed interval of reals
+ *
+ * The operations round outwards: the arithmetic by one ulp where it is not exact, and the library
+ * functions, which may be one ulp off on either side, by two: the result of an operation contains the result of the same operation on
+ * any values taken from its operands. The values outside the domain of a function are ignored,
+ * and if there are none inside, or the result is unbounded, the result is `entire()`.
+ */
+struct interval
+{
+    const_t lo;
+    const_t hi;
+
+    constexpr interval(const_t value) noexcept : lo{value}, hi{value} {}  // NOLINT: a constant of the expressions
+    constexpr interval(const_t lo, const_t hi) noexcept : lo{lo}, hi{hi} {}
+
+    static constexpr auto entire() noexcept
+    {
+        return interval{-std::numeric_limits<const_t>::infinity(), std::numeric_limits<const_t>::infinity()};
+    }
+
+    [[nodiscard]] constexpr auto width() const noexcept { return hi - lo; }
+    [[nodiscard]] constexpr auto midpoint() const noexcept { return lo + (hi - lo) / 2; }
+    [[nodiscard]] constexpr auto contains(const_t x) const noexcept { return lo <= x and x <= hi; }
+    [[nodiscard]] auto is_finite() const noexcept { return std::isfinite(lo) and std::isfinite(hi); }
+};
+
+auto operator+(interval const & a, interval const & b) -> interval;
+auto operator-(interval const & a, interval const & b) -> interval;
+auto operator*(interval const & a, interval const & b) -> interval;
+auto operator/(interval const & a, interval const & b) -> interval;
+constexpr auto operator-(interval const & a) noexcept -> interval { return {-a.hi, -a.lo}; }
+
+auto sin(interval const & a) -> interval;
+auto cos(interval const & a) -> interval;
+auto tan(interval const & a) -> interval;
+auto asin(interval const & a) -> interval;
+auto acos(interval const & a) -> interval;
+auto atan(interval const & a) -> interval;
+auto exp(interval const & a) -> interval;
+auto log(interval const & a) -> interval;
+auto sqrt(interval const & a) -> interval;
+auto cbrt(interval const & a) -> interval;
+auto abs(interval const & a) -> interval;
+auto pow(interval const & a, interval const & b) -> interval;
+auto modulus(interval const & a, interval const & b) -> interval;  // as the `%` of the expressions
+
+/** The sign of the values of `a`, a subset of [-1, 1] */
+constexpr auto sign(interval const & a) noexcept -> interval
+{
+    auto const sign_of = [](const_t x) { return x > 0. ? 1. : x < 0. ? -1. : 0.; };
+    return {sign_of(a.lo), sign_of(a.hi)};
+}
+
+constexpr auto is_zero(interval const & a) noexcept { return a.lo == 0. and a.hi == 0.; }
+
+/** The slopes of a step function taking the values `step`: unbounded if it jumps */
+constexpr auto step_slope(interval const & step) noexcept -> interval
+{
+    return step.lo == step.hi ? interval{0.} : interval::entire();
+}
+
+}  // namespace brun::expr
+
+#endif /* BRUN_EXPR_INTERVAL_HPP */
@@ -0,0 +1,72 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : jit
+ * @created     : Tuesday Oct 20, 2026 10:12:36 CEST
+ * @description : native compilation of the expressions
+ * */
+
+#ifndef BRUN_EXPR_JIT_HPP
+#define BRUN_EXPR_JIT_HPP
+
+#include <expression.hpp>
+#include <cstddef>
+#include <memory>
+#include <span>
+
+namespace brun::expr
+{
+
+/**
+ * @brief An expression of one parameter compiled to x86-64 machine code
+ *
+ * Two functions are emitted in an executable buffer: a scalar one with SSE2 instructions and, if
+ * the CPU supports AVX2, a batch one which evaluates four values at a time. The arithmetic
+ * operators, `sqrt` and `abs` become single instructions; the other functions call the same
+ * library functions as `expression::eval`, one lane at a time, so the results are bitwise equal.
+ *
+ * On other architectures, or if the expression needs more than 14 registers or the executable
+ * buffer cannot be mapped, the calls fall back to the interpreter.
+ */
+class compiled_expression
+{
+public:
+    compiled_expression(expression expr, param_t param);
+
+    /** Evaluates the expression for a value of the parameter */
+    [[nodiscard]] auto operator()(const_t value) const -> const_t
+    {
+        return _scalar != nullptr ? _scalar(value) : _expression.eval({{_param, value}});
+    }
+
+    /** Evaluates the expression for each value of the parameter; `out` must be as long as `values` */
+    void operator()(std::span<const_t const> values, std::span<const_t> out) const;
+
+    /** Whether the expression runs as native code */
+    [[nodiscard]] auto native() const noexcept { return _scalar != nullptr; }
+
+    /** Whether the batches run four values at a time */
+    [[nodiscard]] auto vectorized() const noexcept { return _batch != nullptr; }
+
+    /** The interpreted expression, to evaluate it on other number types */
+    [[nodiscard]] auto tree() const noexcept -> expression const & { return _expression; }
+
+private:
+    using scalar_fn = const_t (*)(const_t);
+    using batch_fn = void (*)(const_t const *, const_t *, std::size_t);  // groups of four values
+
+    struct unmap
+    {
+        std::size_t size;
+        void operator()(void * memory) const noexcept;
+    };
+
+    expression _expression;
+    param_t _param;
+    std::unique_ptr<void, unmap> _code;
+    scalar_fn _scalar = nullptr;
+    batch_fn _batch = nullptr;
+};
+
+}  // namespace brun::expr
+
+#endif /* BRUN_EXPR_JIT_HPP */
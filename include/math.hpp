@@ -35,5 +35,6 @@
 #include "math/values.hpp" // IWYU pragma: export
 #include "math/vector.hpp" // IWYU pragma: export
 #include "math/element_wise.hpp" // IWYU pragma: export
+#include "math/banded.hpp" // IWYU pragma: export
 
 #endif /* ROPES_MATH_HPP */
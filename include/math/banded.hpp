@@ -0,0 +1,149 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : banded
+ * @created     : Saturday Oct 17, 2026 10:12:37 CEST
+ * @description : banded square matrix with an in-place LU factorization
+ * @license     :
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ * 
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ * 
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ * */
+
+#ifndef MATH_BANDED_HPP
+#define MATH_BANDED_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace math
+{
+
+/**
+ * @brief A square matrix whose non-zero elements lie within `bandwidth` of the diagonal,
+ * stored row by row as `2 * bandwidth + 1` elements per row.
+ */
+template <typename T>
+class banded_matrix
+{
+    std::ptrdiff_t _size;
+    std::ptrdiff_t _bandwidth;
+    std::vector<T> _data;
+
+    [[nodiscard]] constexpr
+    auto index(std::ptrdiff_t i, std::ptrdiff_t j) const noexcept -> std::size_t
+    { return static_cast<std::size_t>(i * (2 * _bandwidth + 1) + (j - i + _bandwidth)); }
+
+public:
+    constexpr banded_matrix(std::ptrdiff_t size, std::ptrdiff_t bandwidth) :
+        _size{size},
+        _bandwidth{bandwidth},
+        _data(static_cast<std::size_t>(size * (2 * bandwidth + 1)), T{})
+    {}
+
+    [[nodiscard]] constexpr auto size() const noexcept { return _size; }
+    [[nodiscard]] constexpr auto bandwidth() const noexcept { return _bandwidth; }
+
+    [[nodiscard]] constexpr
+    bool in_band(std::ptrdiff_t i, std::ptrdiff_t j) const noexcept
+    {
+        return i >= 0 and j >= 0 and i < _size and j < _size
+           and j - i <= _bandwidth and i - j <= _bandwidth;
+    }
+
+    /// Element (i, j); it must lie within the band
+    [[nodiscard]] constexpr
+    auto operator()(std::ptrdiff_t i, std::ptrdiff_t j) noexcept -> T & { return _data[index(i, j)]; }
+
+    /// Element (i, j), or zero outside the band
+    [[nodiscard]] constexpr
+    auto operator()(std::ptrdiff_t i, std::ptrdiff_t j) const noexcept -> T
+    { return in_band(i, j) ? _data[index(i, j)] : T{}; }
+
+    /**
+     * @brief Computes `out = A * x`
+     */
+    constexpr
+    void multiply(std::span<T const> const x, std::span<T> const out) const noexcept
+    {
+        for (auto i = std::ptrdiff_t{0}; i < _size; ++i) {
+            auto sum = T{};
+            auto const last = std::min(_size - 1, i + _bandwidth);
+            for (auto j = std::max(std::ptrdiff_t{0}, i - _bandwidth); j <= last; ++j) {
+                sum += _data[index(i, j)] * x[j];
+            }
+            out[i] = sum;
+        }
+    }
+
+    /**
+     * @brief Replaces the matrix with its LU factorization, without pivoting so that the band
+     * is preserved. Meant for diagonally dominant or positive definite matrices.
+     *
+     * @return false if a pivot vanishes; the matrix content is unspecified in that case
+     */
+    constexpr
+    bool factorize() noexcept
+    {
+        for (auto k = std::ptrdiff_t{0}; k < _size; ++k) {
+            auto const pivot = _data[index(k, k)];
+            if (pivot == T{} or pivot != pivot) {
+                return false;
+            }
+            auto const last = std::min(_size - 1, k + _bandwidth);
+            for (auto i = k + 1; i <= last; ++i) {
+                auto & l = _data[index(i, k)];
+                l /= pivot;
+                for (auto j = k + 1; j <= last; ++j) {
+                    _data[index(i, j)] -= l * _data[index(k, j)];
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Solves `A x = rhs` in place, where `A` has already been factorized
+     */
+    constexpr
+    void solve(std::span<T> const rhs) const noexcept
+    {
+        for (auto i = std::ptrdiff_t{0}; i < _size; ++i) {
+            for (auto j = std::max(std::ptrdiff_t{0}, i - _bandwidth); j < i; ++j) {
+                rhs[i] -= _data[index(i, j)] * rhs[j];
+            }
+        }
+        for (auto i = _size - 1; i >= 0; --i) {
+            auto const last = std::min(_size - 1, i + _bandwidth);
+            for (auto j = i + 1; j <= last; ++j) {
+                rhs[i] -= _data[index(i, j)] * rhs[j];
+            }
+            rhs[i] /= _data[index(i, i)];
+        }
+    }
+};
+
+} // namespace math
+
+#endif /* MATH_BANDED_HPP */
@@ -0,0 +1,48 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : modal
+ * @created     : Friday Oct 23, 2026 15:20:36 CEST
+ * @description : natural frequencies and mode shapes of the rope
+ * */
+
+#ifndef MODAL_HPP
+#define MODAL_HPP
+
+#include <simulation.hpp>
+#include <vector>
+
+namespace sym
+{
+
+struct mode
+{
+    ph::frequency frequency;
+    std::vector<ph::vector<>> shape;  // the displacement of each point, the largest of norm 1
+};
+
+/**
+ * @brief Computes the lowest natural frequencies of the rope and their mode shapes
+ *
+ * The accelerations are linearized around the rope at rest (`acceleration_jacobian`, which is block
+ * tridiagonal), and the undamped modes solve `K φ = ω² M φ`. The stiffness is symmetrized with the
+ * square root of the masses, and the lowest modes are the largest eigenvalues of its inverse, found
+ * by the Lanczos iteration on the banded factorization. The j-th of the K iterations costs a band
+ * solve and the reorthogonalization against the j previous vectors, so the whole costs O(n·K²) for
+ * n points and keeps K vectors of n points; K is a few times `count`, so the cost is linear in the
+ * number of points but quadratic in the number of modes. The fixed points do not move in any mode; a
+ * rope with no fixed points has modes of zero frequency, its rigid motions, as do the unstable
+ * directions of a rope far from its equilibrium.
+ *
+ * @param settings the settings from the CLI and UI
+ * @param rope the state to linearize around, usually the static equilibrium
+ * @param count the number of modes, at most two per free point
+ * @return the modes sorted by increasing frequency
+ * @throw std::runtime_error if the stiffness cannot be factorized
+ */
+auto natural_modes(
+    sym::settings const & settings, std::span<ph::state const> rope, int count
+) -> std::vector<sym::mode>;
+
+}  // namespace sym
+
+#endif /* MODAL_HPP */
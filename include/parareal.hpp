@@ -0,0 +1,58 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : parareal
+ * @created     : Thursday Oct 22, 2026 16:42:18 CEST
+ * @description : parallel in time integration of long runs
+ * */
+
+#ifndef PARAREAL_HPP
+#define PARAREAL_HPP
+
+#include <simulation.hpp>
+#include <vector>
+
+namespace sym
+{
+
+struct parareal_options
+{
+    int slices = 0;  // the time slices; zero for one per worker of the pool, plus the calling thread
+    ph::duration coarse_dt = ph::duration::zero();  // of the coarse propagator; zero to use a stable one
+    ph::length tolerance = 1e-6 * ph::m;  // on the largest change of a position between two iterations
+    int max_iterations = 0;  // zero for as many as the slices, after which the result is exact
+};
+
+struct parareal_result
+{
+    std::vector<std::vector<ph::state>> boundaries;  // the rope at the beginning of each slice and at the end
+    std::vector<ph::time> times;  // of the boundaries
+    int iterations = 0;
+    ph::length residual = ph::length::zero();  // the largest change of a position at the last iteration
+    bool converged = false;
+};
+
+/**
+ * @brief Integrates [t0, t1] in parallel in time, with the Parareal iteration
+ *
+ * The interval is split in time slices, all integrated at once: from a guess of the state at the
+ * beginning of each slice, the fine propagator (`sym::integrate` with `settings.dt`) runs on all
+ * the slices concurrently, and a coarse one (symplectic Euler with a large time-step) carries the
+ * corrections across the slices in a sequential sweep, until the states at the boundaries stop
+ * changing. The k-th iteration makes the first k slices exact, so the result is the one of the
+ * sequential integration after as many iterations as the slices; it pays off when it converges in
+ * a few, on long runs of ropes too short to keep all the workers busy with the points alone.
+ *
+ * @param settings the settings from the CLI and UI
+ * @param rope the state of the rope at `t0`
+ * @param t0 the beginning of the interval
+ * @param t1 the end of the interval
+ * @param options the slices, the coarse propagator and the stopping criterion
+ */
+auto parareal(
+    sym::settings const & settings, std::span<ph::state const> rope, ph::time t0, ph::time t1,
+    sym::parareal_options const & options = {}
+) -> sym::parareal_result;
+
+}  // namespace sym
+
+#endif /* PARAREAL_HPP */
@@ -0,0 +1,365 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : parser
+ * @created     : Wednesday Oct 21, 2026 09:48:26 CEST
+ * @description : single pass parser of the expressions
+ * */
+
+#ifndef BRUN_EXPR_PARSER_HPP
+#define BRUN_EXPR_PARSER_HPP
+
+#include <expression.hpp>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <expected>
+#include <limits>
+#include <numbers>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * A precedence climbing (Pratt) parser, reading the source once and emitting the tree in a flat
+ * array, the children before their parent. Everything is constexpr, so the same code parses the
+ * formulas typed at runtime (`expression`) and those known to the compiler (`static_expression`).
+ *
+ * From the loosest to the tightest:
+ * - `%`
+ * - binary `+` and `-`
+ * - `*`, `/` and the implicit multiplication (`2t`, `2(t+1)`, `(t+1)(t-1)`)
+ * - `^`
+ * - unary `-` and `+`, whose operand extends over `^` only: `-t^2` is `-(t^2)`
+ * - the functions, whose argument is a single operand: `sin t^2` is `(sin t)^2`
+ * All the binary operators are left associative.
+ */
+namespace brun::expr::parser
+{
+
+struct ir_node
+{
+    enum class kind : std::uint8_t { constant, parameter, function } type = kind::constant;
+    const_t value = 0;  // of the constants
+    param_t name = '\0';  // of the parameters
+    char op = '\0';  // of the functions, as `node::op`
+    int left = -1;  // the operand of the unary functions
+    int right = -1;
+};
+
+struct error
+{
+    std::size_t position;  // in characters, from 0
+    std::string_view message;
+};
+
+constexpr auto is_binary(char c) noexcept { return std::string_view{"+-*/^%"}.contains(c); }
+
+namespace detail
+{
+constexpr auto is_digit(char c) noexcept { return c >= '0' and c <= '9'; }
+constexpr auto is_space(char c) noexcept { return std::string_view{" \t\n\v\f\r"}.contains(c); }
+constexpr auto is_alpha(char c) noexcept { return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z'); }
+constexpr auto to_lower(char c) noexcept { return c >= 'A' and c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; }
+
+constexpr auto binding_power(char op) noexcept
+{
+    switch (op) {
+        case '%': return 1;
+        case '+': case '-': return 2;
+        case '*': case '/': return 3;
+        case '^': return 4;
+        default: return 0;
+    }
+}
+constexpr auto prefix_power = 3;
+constexpr auto function_power = 5;
+
+/**
+ * As `std::from_chars` in the general format, which is not constexpr for floating point numbers.
+ * At compile time the result is correctly rounded when the significant digits fit in 53 bits and the
+ * exponent is at most 22, as in every formula written by hand; otherwise it may be one ulp off.
+ * A number too large or too small for `const_t` is infinity or zero, at compile time as at run time.
+ */
+constexpr auto match_real(std::string_view s) -> std::pair<std::optional<const_t>, std::size_t>
+{
+    if !consteval {
+        auto value = const_t{};
+        auto const [end, error] = std::from_chars(s.data(), s.data() + s.size(), value);
+        if (error == std::errc{}) {
+            return {value, static_cast<std::size_t>(end - s.data())};
+        }
+        if (error != std::errc::result_out_of_range) {
+            return {std::nullopt, 0};
+        }
+        // the value is left untouched: the loop below saturates it
+    }
+    auto i = 0uz;
+    auto const starts_with = [&](std::string_view word) {
+        return s.size() - i >= word.size() and std::ranges::equal(s.substr(i, word.size()), word, {}, to_lower);
+    };
+    if (starts_with("inf")) {
+        return {std::numeric_limits<const_t>::infinity(), starts_with("infinity") ? 8 : 3};
+    }
+    if (starts_with("nan")) {
+        i = 3;
+        if (i < s.size() and s[i] == '(') {
+            auto j = i + 1;
+            while (j < s.size() and (is_digit(s[j]) or is_alpha(s[j]) or s[j] == '_')) {
+                ++j;
+            }
+            i = j < s.size() and s[j] == ')' ? j + 1 : i;
+        }
+        return {std::numeric_limits<const_t>::quiet_NaN(), i};
+    }
+
+    auto mantissa = std::uint64_t{0};
+    auto significant = 0;
+    auto exponent = 0;
+    auto digits = false;
+    auto const digit = [&](bool fraction) {
+        auto const d = static_cast<std::uint64_t>(s[i++] - '0');
+        digits = true;
+        if (significant < 19) {
+            mantissa = mantissa * 10 + d;
+            significant += mantissa != 0 ? 1 : 0;
+            exponent -= fraction ? 1 : 0;
+        } else if (not fraction) {
+            ++exponent;
+        }
+    };
+    while (i < s.size() and is_digit(s[i])) {
+        digit(false);
+    }
+    if (i < s.size() and s[i] == '.') {
+        ++i;
+        while (i < s.size() and is_digit(s[i])) {
+            digit(true);
+        }
+    }
+    if (not digits) {
+        return {std::nullopt, 0};
+    }
+    if (i < s.size() and (s[i] == 'e' or s[i] == 'E')) {
+        auto j = i + 1;
+        auto const negative = j < s.size() and s[j] == '-';
+        j += j < s.size() and (s[j] == '-' or s[j] == '+') ? 1 : 0;
+        if (j < s.size() and is_digit(s[j])) {
+            auto value = 0;
+            for (; j < s.size() and is_digit(s[j]); ++j) {
+                value = std::min(value * 10 + (s[j] - '0'), 100'000);
+            }
+            exponent += negative ? -value : value;
+            i = j;
+        }
+    }
+
+    if (mantissa == 0) {
+        return {0., i};
+    }
+    if (mantissa < (std::uint64_t{1} << 53U) and exponent >= -22 and exponent <= 22) {
+        auto power = 1.;  // exact up to 1e22
+        for (auto k = 0; k < std::abs(exponent); ++k) {
+            power *= 10;
+        }
+        auto const value = static_cast<const_t>(mantissa);
+        return {exponent < 0 ? value / power : value * power, i};
+    }
+    auto value = static_cast<long double>(mantissa);
+    for (auto k = 0; k < std::min(std::abs(exponent), 400); ++k) {
+        value = exponent < 0 ? value / 10 : value * 10;
+    }
+    if (value > std::numeric_limits<const_t>::max()) {
+        return {std::numeric_limits<const_t>::infinity(), i};
+    }
+    if (value < std::numeric_limits<const_t>::denorm_min() / 2) {
+        return {0., i};
+    }
+    return {static_cast<const_t>(value), i};
+}
+
+// the function at the beginning of the string and the length of its name
+constexpr auto match_function(std::string_view str) -> std::optional<std::pair<char, std::size_t>>
+{
+    constexpr auto functions = std::array<std::pair<std::string_view, char>, 12>{{
+        {"sin", 's'}, {"cos", 'c'}, {"tan", 't'}, {"asin", 'S'}, {"acos", 'C'}, {"atan", 'T'},
+        {"ln", 'l'}, {"log", 'l'}, {"exp", 'e'}, {"abs", '|'}, {"sqrt", 'v'}, {"cbrt", 'V'}
+    }};
+    for (auto const & [name, op] : functions) {
+        if (str.starts_with(name)) {
+            return std::pair{op, name.size()};
+        }
+    }
+    return std::nullopt;
+}
+
+constexpr auto match_pi(std::string_view str) -> std::optional<std::size_t>
+{
+    for (std::string_view const pi : {"pi", "PI", "Pi", "π"}) {
+        if (str.starts_with(pi)) {
+            return pi.size();
+        }
+    }
+    return std::nullopt;
+}
+
+class pratt
+{
+    std::string_view _source;
+    std::string_view _params;
+    std::size_t _pos = 0;
+    std::vector<ir_node> _nodes;
+    std::optional<error> _error;
+
+public:
+    constexpr pratt(std::string_view source, std::string_view params) : _source{source}, _params{params} {}
+
+    constexpr auto run() && -> std::expected<std::vector<ir_node>, error>
+    {
+        skip_spaces();
+        if (at_end()) {
+            _nodes.push_back({.type = ir_node::kind::constant, .value = 0.});
+            return std::move(_nodes);
+        }
+        if (parse(0) != -1 and not at_end()) {
+            fail(_pos, _source[_pos] == ')' ? "unmatched ')'" : "expected an operator");
+        }
+        if (_error) {
+            return std::unexpected{*_error};
+        }
+        return std::move(_nodes);
+    }
+
+private:
+    [[nodiscard]] constexpr auto at_end() const noexcept -> bool { return _pos == _source.size(); }
+    [[nodiscard]] constexpr auto rest() const noexcept -> std::string_view { return _source.substr(_pos); }
+
+    constexpr void skip_spaces() noexcept
+    {
+        while (not at_end() and is_space(_source[_pos])) {
+            ++_pos;
+        }
+    }
+
+    constexpr auto push(ir_node n) -> int
+    {
+        _nodes.push_back(n);
+        return static_cast<int>(_nodes.size()) - 1;
+    }
+
+    // records the first error, with its position counted in UTF-8 characters
+    constexpr auto fail(std::size_t position, std::string_view message) -> int
+    {
+        if (not _error) {
+            auto const characters = std::ranges::count_if(_source.substr(0, position), [](char c) {
+                return (static_cast<unsigned char>(c) & 0xC0U) != 0x80U;
+            });
+            _error = error{static_cast<std::size_t>(characters), message};
+        }
+        return -1;
+    }
+
+    // an expression whose operators bind tighter than `min_power`; the index of its root, or -1
+    constexpr auto parse(int min_power) -> int  // NOLINT(misc-no-recursion)
+    {
+        auto left = operand();
+        while (left != -1) {
+            skip_spaces();
+            if (at_end() or _source[_pos] == ')') {
+                break;
+            }
+            auto const explicit_op = is_binary(_source[_pos]);
+            auto const op = explicit_op ? _source[_pos] : '*';  // anything else starts an operand
+            if (binding_power(op) <= min_power) {
+                break;
+            }
+            _pos += explicit_op ? 1 : 0;
+            auto const right = parse(binding_power(op));
+            if (right == -1) {
+                return -1;
+            }
+            left = push({.type = ir_node::kind::function, .op = op, .left = left, .right = right});
+        }
+        return left;
+    }
+
+    constexpr auto operand() -> int  // NOLINT(misc-no-recursion)
+    {
+        using enum ir_node::kind;
+        skip_spaces();
+        if (at_end()) {
+            return fail(_pos, "expected an operand");
+        }
+        auto const c = _source[_pos];
+        if (c == '-' or c == '+') {
+            ++_pos;
+            auto const argument = parse(prefix_power);
+            if (argument == -1 or c == '+') {
+                return argument;
+            }
+            return push({.type = function, .op = 'n', .left = argument});
+        }
+        if (c == '(') {
+            auto const open = _pos++;
+            skip_spaces();
+            if (not at_end() and _source[_pos] == ')') {
+                return fail(_pos, "empty parentheses");
+            }
+            auto const inner = parse(0);
+            if (inner == -1) {
+                return -1;
+            }
+            if (at_end()) {
+                return fail(open, "unterminated parenthesis");
+            }
+            ++_pos;  // the ')'
+            return inner;
+        }
+        if (c == ')') {
+            return fail(_pos, "expected an operand");
+        }
+        if (auto const match = match_function(rest()); match.has_value()) {
+            _pos += match->second;
+            auto const argument = parse(function_power);
+            if (argument == -1) {
+                return -1;
+            }
+            return push({.type = function, .op = match->first, .left = argument});
+        }
+        if (auto const [value, length] = match_real(rest()); value.has_value()) {
+            _pos += length;
+            // "2..3" is a typo, not 2·0.3
+            if (not at_end() and (is_digit(_source[_pos]) or _source[_pos] == '.')) {
+                return fail(_pos, "expected an operator");
+            }
+            return push({.type = constant, .value = *value});
+        }
+        if (auto const length = match_pi(rest()); length.has_value()) {
+            _pos += *length;
+            return push({.type = constant, .value = std::numbers::pi_v<const_t>});
+        }
+        if (c == 'e') {
+            ++_pos;
+            return push({.type = constant, .value = std::numbers::e_v<const_t>});
+        }
+        if (_params.contains(c)) {
+            ++_pos;
+            return push({.type = parameter, .name = c});
+        }
+        return fail(_pos, is_binary(c) ? "expected an operand" : "unexpected character");
+    }
+};
+}  // namespace detail
+
+/** Parses an expression of the parameters `params`; an empty source is the constant 0 */
+constexpr auto parse(std::string_view source, std::string_view params)
+    -> std::expected<std::vector<ir_node>, error>
+{
+    return detail::pratt{source, params}.run();
+}
+
+}  // namespace brun::expr::parser
+
+#endif /* BRUN_EXPR_PARSER_HPP */
@@ -14,6 +14,7 @@
 #include <mp-units/format.h>
 
 #include <math.hpp>
+#include <buffer.hpp>
 
 template<class T, auto N>
 requires mp_units::is_scalar<T>
@@ -46,12 +47,14 @@ using damping_coefficient = quantity<N * s / m>;
 using linear_density = quantity<kg / m>;
 
 using position = vector<length>;
+using direction = vector<quantity<one>>;
 using velocity = vector<speed>;
 using acceleration = vector<magnitude_of_acceleration>;
 using force = vector<quantity<N>>;
 using energy = quantity<J>;
 
 using framerate = quantity<Hz>;
+using frequency = quantity<Hz>;
 
 struct metadata
 {
@@ -77,10 +80,11 @@ struct derivative
     ph::acceleration dv;
 };
 
+// on the allocator of the scratch buffers of the steps, since the callers swap them with the rope
 struct simulation_data
 {
-    std::vector<ph::state> state;
-    std::vector<ph::metadata> metadata;
+    sym::memory::vector<ph::state> state;
+    sym::memory::vector<ph::metadata> metadata;
 };
 
 constexpr inline struct numerical_value_in_fn
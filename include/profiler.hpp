@@ -0,0 +1,144 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : profiler
+ * @created     : Saturday Oct 17, 2026 20:14:36 CEST
+ * @description : hardware performance counters around named zones
+ * */
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+namespace sym::profiler
+{
+
+enum class event : std::uint8_t { cycles, instructions, l1d_misses, llc_misses, branch_misses };
+
+constexpr inline auto events = std::array{
+    event::cycles, event::instructions, event::l1d_misses, event::llc_misses, event::branch_misses
+};
+
+enum class zone_id : std::uint8_t {
+    step, stage_1, stage_2, stage_3, stage_4, acceleration, render, shape, expression
+};
+
+constexpr inline auto zones = std::array{
+    zone_id::step, zone_id::stage_1, zone_id::stage_2, zone_id::stage_3, zone_id::stage_4,
+    zone_id::acceleration, zone_id::render, zone_id::shape, zone_id::expression
+};
+
+constexpr auto name(event e) noexcept -> std::string_view
+{
+    switch (e) {
+    case event::cycles:        return "Cycles";
+    case event::instructions:  return "Instructions";
+    case event::l1d_misses:    return "L1d misses";
+    case event::llc_misses:    return "LLC misses";
+    case event::branch_misses: return "Branch misses";
+    }
+    return "";
+}
+
+constexpr auto name(zone_id z) noexcept -> std::string_view
+{
+    switch (z) {
+    case zone_id::step:         return "step";
+    case zone_id::stage_1:      return "RK stage 1";
+    case zone_id::stage_2:      return "RK stage 2";
+    case zone_id::stage_3:      return "RK stage 3";
+    case zone_id::stage_4:      return "RK stage 4";
+    case zone_id::acceleration: return "acceleration";
+    case zone_id::render:       return "render";
+    case zone_id::shape:        return "shape sampling";
+    case zone_id::expression:   return "expression eval";
+    }
+    return "";
+}
+
+/**
+ * Whether the counts of a zone are reported per point per step, like the work of the steps, or per
+ * call, like the frames and the evaluations of the formulas
+ */
+constexpr auto per_point(zone_id z) noexcept -> bool
+{
+    switch (z) {
+    case zone_id::step:
+    case zone_id::stage_1:
+    case zone_id::stage_2:
+    case zone_id::stage_3:
+    case zone_id::stage_4:
+    case zone_id::acceleration:
+        return true;
+    case zone_id::render:
+    case zone_id::shape:
+    case zone_id::expression:
+        return false;
+    }
+    return false;
+}
+
+using counts = std::array<std::uint64_t, events.size()>;
+
+/** The counts of a zone since the last `reset` */
+struct result
+{
+    std::uint64_t calls = 0;
+    counts values = {};
+    std::array<bool, events.size()> available = {};  // whether the CPU could count the event
+};
+
+namespace detail
+{
+extern std::atomic<bool> enabled;
+}
+
+/**
+ * @brief Starts or stops counting. Zones entered while the profiler is disabled cost a branch.
+ *
+ * @return false if no counter could be opened (not Linux, or perf_event_paranoid too high)
+ */
+auto enable(bool on = true) -> bool;
+
+/** Whether the profiler is counting */
+[[nodiscard]] inline auto enabled() noexcept -> bool { return detail::enabled.load(std::memory_order_relaxed); }
+
+/** The counts of a zone, summed over all the threads */
+[[nodiscard]] auto read(zone_id z) noexcept -> result;
+
+/** Sets all the counts to zero */
+void reset() noexcept;
+
+/**
+ * @brief Counts the events of the current thread from construction to destruction. Work handed to
+ * other threads (e.g. the parallel loops of big ropes) is not counted.
+ */
+class zone
+{
+    zone_id _id;
+    bool _active;
+    counts _start;
+
+public:
+    explicit zone(zone_id id) noexcept;
+    ~zone();
+
+    zone(zone const &) = delete;
+    zone(zone &&) = delete;
+    auto operator=(zone const &) -> zone & = delete;
+    auto operator=(zone &&) -> zone & = delete;
+};
+
+/**
+ * @brief Prints a table with the counts of each zone divided by the number of points and steps, or
+ * by its calls if it is not `per_point`, with the instructions per cycle: few instructions per
+ * cycle and many cache misses per point mean that the zone is memory-bound
+ */
+void report(std::size_t points, std::size_t steps);
+
+}  // namespace sym::profiler
+
+#endif /* PROFILER_HPP */
@@ -0,0 +1,58 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : publisher
+ * @created     : Sunday Oct 18, 2026 09:40:03 CEST
+ * @description : publishes the rope in a POSIX shared-memory ring
+ * */
+
+#ifndef PUBLISHER_HPP
+#define PUBLISHER_HPP
+
+#include <physics.hpp>
+#include <span>
+#include <string>
+
+namespace sym
+{
+
+/**
+ * @brief Writes each frame in a ring of slots of a POSIX shared memory object, whose layout is
+ * described in `include/ropes_shm.h`. Each slot is guarded by a seqlock, so readers never block
+ * the writer: they copy a frame and retry if it was overwritten meanwhile.
+ */
+class shm_publisher
+{
+    std::string _name;
+    void * _memory = nullptr;
+    std::size_t _size = 0;
+
+public:
+    /**
+     * @brief Creates (or replaces) the shared memory object
+     *
+     * @param name the name of the object, like "/ropes"
+     * @param capacity the maximum number of points of a frame; bigger ropes are truncated
+     * @param slots the number of frames in the ring
+     * @throw std::system_error if the object cannot be created or mapped
+     */
+    shm_publisher(std::string name, std::size_t capacity, std::uint32_t slots = 4);
+    ~shm_publisher();
+
+    shm_publisher(shm_publisher const &) = delete;
+    shm_publisher(shm_publisher &&) = delete;
+    auto operator=(shm_publisher const &) -> shm_publisher & = delete;
+    auto operator=(shm_publisher &&) -> shm_publisher & = delete;
+
+    /**
+     * @brief Publishes a frame
+     *
+     * @param t the simulation time
+     * @param rope the rope
+     * @param metadata the forces on each point; may be empty
+     */
+    void publish(ph::time t, std::span<ph::state const> rope, std::span<ph::metadata const> metadata);
+};
+
+}  // namespace sym
+
+#endif /* PUBLISHER_HPP */
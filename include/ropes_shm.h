@@ -0,0 +1,58 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : ropes_shm
+ * @created     : Sunday Oct 18, 2026 09:12:40 CEST
+ * @description : layout of the shared-memory ring published by `ropes --shm <name>`
+ *
+ * The shared memory object starts with a `ropes_shm_header`; the first of the `slots` frames is at
+ * offset ROPES_SHM_FRAMES_OFFSET, and the others follow `slot_stride` bytes apart. Each frame is a `ropes_shm_frame` followed by `n_points`
+ * `ropes_shm_point`. All the values are in SI units, in the frame of the simulation: the y axis
+ * points downwards.
+ *
+ * To read the last frame:
+ *  1. g = atomic load (acquire) of `header.latest`; if zero, nothing was published yet
+ *  2. frame = slot (g - 1) % `header.slots`
+ *  3. s1 = atomic load (acquire) of `frame.sequence`; if odd, the frame is being written: retry
+ *  4. copy the frame, then issue an acquire fence
+ *  5. s2 = atomic load (relaxed) of `frame.sequence`; if s1 != s2 the copy is torn: retry
+ * With gcc and clang, use `__atomic_load_n(&field, __ATOMIC_ACQUIRE)` and
+ * `__atomic_thread_fence(__ATOMIC_ACQUIRE)`.
+ */
+
+#ifndef ROPES_SHM_H
+#define ROPES_SHM_H
+
+#include <stdint.h>
+
+#define ROPES_SHM_MAGIC UINT64_C(0x314D485345504F52) /* "ROPESHM1" in little endian */
+#define ROPES_SHM_VERSION 1
+#define ROPES_SHM_FRAMES_OFFSET 64
+
+struct ropes_shm_header
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t slots;        /* number of frames in the ring */
+    uint64_t capacity;     /* maximum number of points of a frame */
+    uint64_t slot_stride;  /* bytes from a frame to the next one */
+    uint64_t latest;       /* number of frames published so far */
+};
+
+struct ropes_shm_frame
+{
+    uint64_t sequence;     /* odd while the frame is being written */
+    uint64_t generation;   /* the value of `latest` that published this frame */
+    double time;           /* simulation time in s */
+    uint64_t n_points;     /* points in this frame, at most `capacity` */
+    uint64_t total_points; /* points of the rope; more than n_points if it outgrew the capacity */
+    uint64_t padding;
+};
+
+struct ropes_shm_point
+{
+    double x, y;           /* position in m */
+    double vx, vy;         /* velocity in m/s */
+    double fx, fy;         /* total force in N, zero if the metadata is not computed */
+};
+
+#endif /* ROPES_SHM_H */
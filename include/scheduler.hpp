@@ -0,0 +1,208 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : scheduler
+ * @created     : Saturday Oct 17, 2026 16:02:13 CEST
+ * @description : work-stealing task pool shared by the whole program
+ * */
+
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include "allocations.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sym
+{
+
+/**
+ * The chunk size of the parallel loops over the points of a rope: below it, the synchronization
+ * costs more than the forces. Chunk `c` of a loop is always
+ * queued on worker `c % size()`, so with the same grain a worker keeps touching the same memory.
+ */
+constexpr inline auto parallel_grain = std::ptrdiff_t{4096};
+
+/**
+ * @brief A pool of workers, each with its own deque of tasks.
+ *
+ * A worker pushes and pops the tasks it spawns at the back of its deque, and when it runs out of
+ * work it takes the tasks submitted from outside the pool or steals from the front of the deques of
+ * the other workers. A thread waiting for a group of tasks runs pending tasks meanwhile, so
+ * fork-join can be nested at any depth without blocking the pool.
+ *
+ * All the parallel code should share the global pool, which bounds the number of threads of the
+ * whole program.
+ */
+class scheduler
+{
+public:
+    using task = std::function<void()>;
+
+    /**
+     * @brief Starts the workers
+     *
+     * @param workers the number of threads; the thread waiting for a task group helps as well, so
+     * zero workers is allowed and runs everything on the waiting thread
+     * @param pin_threads pin each worker to a different core
+     */
+    explicit scheduler(std::size_t workers, bool pin_threads = false);
+    ~scheduler();
+
+    scheduler(scheduler const &) = delete;
+    scheduler(scheduler &&) = delete;
+    auto operator=(scheduler const &) -> scheduler & = delete;
+    auto operator=(scheduler &&) -> scheduler & = delete;
+
+    /**
+     * @brief Sets the size of the global pool; it has effect only before the first call to `global`
+     *
+     * @param workers the number of workers; zero means one less than the number of cores
+     * @param pin_threads pin each worker to a different core
+     */
+    static void configure(std::size_t workers, bool pin_threads = false);
+
+    /** The pool shared by the whole program, created at the first call */
+    static auto global() -> scheduler &;
+
+    /** The number of workers */
+    [[nodiscard]] auto size() const noexcept { return _workers.size(); }
+
+    /**
+     * @brief Enqueues a task: on the deque of the calling worker, or on the shared queue if the
+     * caller does not belong to the pool
+     */
+    void submit(task t);
+
+    /**
+     * @brief Enqueues a task on the deque of a worker (modulo the number of workers); the worker
+     * keeps it unless it is stolen by an idle one
+     */
+    void submit(task t, std::size_t worker);
+
+    /**
+     * @brief Runs a single pending task, if any
+     *
+     * @return true if a task has been run
+     */
+    auto run_one() -> bool;
+
+    /**
+     * @brief Calls `body(begin, end)` over chunks of at most `grain` indices covering [first, last),
+     * and waits for all of them; the calling thread runs the last chunk, and the others are
+     * spread over the workers in order
+     */
+    template <typename F>
+    void parallel_for(std::ptrdiff_t first, std::ptrdiff_t last, std::ptrdiff_t grain, F && body);
+
+private:
+    struct worker
+    {
+        std::mutex mutex;
+        std::deque<task> tasks;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<worker>> _workers;
+    std::mutex _shared_mutex;
+    std::deque<task> _shared;
+
+    // sleeping workers wake up when a task is submitted or the pool is stopped
+    std::mutex _sleep_mutex;
+    std::condition_variable _wake;
+    std::atomic<std::ptrdiff_t> _queued = 0;
+    bool _stop = false;
+
+    void work(std::size_t id);
+    void push(std::mutex & mutex, std::deque<task> & tasks, task t);
+    auto pop(task & t) -> bool;
+};
+
+/**
+ * @brief A set of tasks to wait for together
+ *
+ * `wait` rethrows the first exception thrown by a task; the destructor waits without rethrowing.
+ * The allocations of a task are charged to the subsystem of the thread which submitted it.
+ */
+class task_group
+{
+    scheduler & _pool;
+    std::atomic<std::ptrdiff_t> _pending = 0;
+    std::mutex _error_mutex;
+    std::exception_ptr _error;
+
+public:
+    explicit task_group(scheduler & pool = scheduler::global()) : _pool{pool} {}
+    ~task_group();
+
+    task_group(task_group const &) = delete;
+    task_group(task_group &&) = delete;
+    auto operator=(task_group const &) -> task_group & = delete;
+    auto operator=(task_group &&) -> task_group & = delete;
+
+    /** Submits a task to the pool */
+    template <typename F>
+    void run(F && f)
+    {
+        _pending.fetch_add(1, std::memory_order_relaxed);
+        _pool.submit(wrap(std::forward<F>(f)));
+    }
+
+    /** Submits a task to the deque of a worker */
+    template <typename F>
+    void run_on(std::size_t worker, F && f)
+    {
+        _pending.fetch_add(1, std::memory_order_relaxed);
+        _pool.submit(wrap(std::forward<F>(f)), worker);
+    }
+
+    /** Runs pending tasks until all the tasks of the group are done */
+    void wait();
+
+private:
+    template <typename F>
+    auto wrap(F && f) -> scheduler::task
+    {
+        return [this, f = std::forward<F>(f), subsystem = allocations::current_subsystem]() mutable {
+            auto const accounting = allocations::scope{subsystem};
+            try {
+                f();
+            } catch (...) {
+                auto lock = std::scoped_lock{_error_mutex};
+                if (not _error) {
+                    _error = std::current_exception();
+                }
+            }
+            _pending.fetch_sub(1, std::memory_order_release);
+        };
+    }
+};
+
+template <typename F>
+void scheduler::parallel_for(std::ptrdiff_t first, std::ptrdiff_t last, std::ptrdiff_t grain, F && body)
+{
+    grain = std::max(grain, std::ptrdiff_t{1});
+    if (last - first <= grain or _workers.empty()) {
+        body(first, last);
+        return;
+    }
+    auto group = task_group{*this};
+    auto begin = first;
+    for (auto chunk = 0uz; last - begin > grain; begin += grain, ++chunk) {
+        group.run_on(chunk, [&body, begin, end = begin + grain] { body(begin, end); });
+    }
+    body(begin, last);
+    group.wait();
+}
+
+}  // namespace sym
+
+#endif /* SCHEDULER_HPP */
@@ -0,0 +1,72 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : shape_cache
+ * @created     : Monday Oct 19, 2026 17:38:05 CEST
+ * @description : cache of the initial shapes of the rope
+ * */
+
+#ifndef SHAPE_CACHE_HPP
+#define SHAPE_CACHE_HPP
+
+#include <simulation.hpp>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace sym
+{
+
+/**
+ * @brief Remembers the positions of the last initial ropes, so resetting the rope to a shape built
+ * recently does not evaluate the formulas, read the shape file or solve the equilibrium again.
+ *
+ * The shapes are kept in memory, least recently used first out, and optionally in a directory,
+ * where they survive the program: each one is a file named after the hash of its key, holding the
+ * key itself and the positions as little endian f64 pairs. A corrupted or unwritable file is
+ * just a miss.
+ */
+class shape_cache
+{
+public:
+    using points = std::vector<math::vector<double, 2>>;
+
+    explicit shape_cache(std::size_t capacity = 8);
+
+    /** The cache used by `sym::initial_rope` */
+    static auto global() -> shape_cache &;
+
+    /** Sets the directory where the shapes are also stored, or disables it if empty */
+    void set_directory(std::filesystem::path directory);
+
+    /** Looks for a shape in memory, then on disk */
+    auto find(std::string const & key) -> std::optional<points>;
+
+    void insert(std::string const & key, points shape);
+
+    /** Identifies the shape of the rope: formulas or shape file, number of points, length */
+    static auto shape_key(sym::settings const & settings) -> std::string;
+
+    /** Identifies the equilibrium of the rope: its shape and everything the forces depend on */
+    static auto equilibrium_key(sym::settings const & settings) -> std::string;
+
+private:
+    struct entry
+    {
+        std::string key;
+        points shape;
+    };
+
+    std::mutex _mutex;
+    std::size_t _capacity;
+    std::list<entry> _entries;  // the most recently used first
+    std::filesystem::path _directory;
+
+    auto path_of(std::string const & key) const -> std::filesystem::path;
+};
+
+}  // namespace sym
+
+#endif /* SHAPE_CACHE_HPP */
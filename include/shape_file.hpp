@@ -0,0 +1,36 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : shape_file
+ * @created     : Monday Oct 19, 2026 14:02:18 CEST
+ * @description : reads the initial shape of the rope from a file of points
+ * */
+
+#ifndef SHAPE_FILE_HPP
+#define SHAPE_FILE_HPP
+
+#include <math.hpp>
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace sym
+{
+
+/**
+ * @brief Reads a polyline from a file of points, with the y axis pointing upwards like the
+ * formulas
+ *
+ * Files ending in `.bin` or `.raw` are arrays of little endian f64 pairs (x, y); any other file is
+ * a text file with a point per line, its coordinates separated by commas, semicolons or blanks.
+ * Further columns, blank lines, lines starting with `#` and a header line are ignored. The file is
+ * memory-mapped and parsed by all the workers of the scheduler, a chunk of about 1 MB each.
+ *
+ * @return the points with the y axis pointing downwards, or a description of the error
+ */
+auto read_points(std::filesystem::path const & path)
+    -> std::expected<std::vector<math::vector<double, 2>>, std::string>;
+
+}  // namespace sym
+
+#endif /* SHAPE_FILE_HPP */
@@ -0,0 +1,69 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : shape_presets
+ * @created     : Tuesday Oct 20, 2026 17:31:08 CEST
+ * @description : built-in initial shapes of the rope
+ * */
+
+#ifndef SHAPE_PRESETS_HPP
+#define SHAPE_PRESETS_HPP
+
+#include <static_expression.hpp>
+#include <interval.hpp>
+#include <dual.hpp>
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+namespace sym
+{
+
+/** A built-in shape: its formulas, as shown in the UI, parsed at compile time */
+struct shape_preset
+{
+    std::string_view name;
+    std::string_view x_formula;
+    std::string_view y_formula;
+    double (*x)(double);
+    double (*y)(double);
+    // the bounds of x and of its derivative over an interval of t
+    brun::expr::dual<brun::expr::interval> (*x_bound)(brun::expr::dual<brun::expr::interval> const &);
+    brun::expr::dual<brun::expr::interval> (*y_bound)(brun::expr::dual<brun::expr::interval> const &);
+};
+
+namespace detail
+{
+template <brun::expr::fixed_string Name, brun::expr::fixed_string X, brun::expr::fixed_string Y>
+consteval auto make_preset() -> shape_preset
+{
+    using x_t = brun::expr::static_expression<X>;
+    using y_t = brun::expr::static_expression<Y>;
+    using bound = brun::expr::dual<brun::expr::interval>;
+    return {
+        Name.view(), x_t::source, y_t::source,
+        [](double t) { return x_t{}(t); }, [](double t) { return y_t{}(t); },
+        [](bound const & t) { return x_t{}(t); }, [](bound const & t) { return y_t{}(t); }
+    };
+}
+}  // namespace detail
+
+inline constexpr auto shape_presets = std::array{
+    detail::make_preset<"Straight line", "t", "0">(),
+    detail::make_preset<"Parabola", "t", "(2*t-1)^2">(),
+    detail::make_preset<"Sine", "t", "sin(2*pi*t)/4">(),
+    detail::make_preset<"Circle", "cos(2*pi*t)", "sin(2*pi*t)">(),
+};
+
+/** The preset with exactly these formulas, if any */
+constexpr auto find_preset(std::string_view x_formula, std::string_view y_formula) noexcept
+    -> shape_preset const *
+{
+    auto const it = std::ranges::find_if(shape_presets, [&](auto const & p) {
+        return p.x_formula == x_formula and p.y_formula == y_formula;
+    });
+    return it != shape_presets.end() ? &*it : nullptr;
+}
+
+}  // namespace sym
+
+#endif /* SHAPE_PRESETS_HPP */
@@ -9,6 +9,11 @@
 #define SIMULATION_HPP
 
 #include <physics.hpp>
+#include <interval.hpp>
+#include <dual.hpp>
+#include <array>
+#include <optional>
+#include <span>
 
 namespace sym
 {
@@ -45,9 +50,25 @@ struct settings
     std::string x_formula;
     std::string y_formula;
     bool equalize_distance;
+    bool start_at_equilibrium;
+
+    // if not empty, the rope takes the shape of the points in this file instead of the formulas
+    std::string shape_file = {};
 
     force_enabled_t enabled;
 
+    // With more than one substep, the forces flagged in `substepped` are integrated with
+    // `substeps` RK4 steps per time-step, while the others are applied as two half-step kicks
+    // around them. With one substep all the forces are integrated together by a single RK4 step.
+    int substeps = 1;
+    force_enabled_t substepped = {
+        .gravity = false,
+        .elastic = true,
+        .external_damping = false,
+        .internal_damping = true,
+        .flexural_rigidity = true
+    };
+
     settings(
         int n_points,
         ph::stiffness k,
@@ -62,7 +83,8 @@ struct settings
         ph::duration duration,
         std::string x_formula = "t",
         std::string y_formula = "0",
-        bool equalize_distance = true
+        bool equalize_distance = true,
+        bool start_at_equilibrium = false
     ) :
         number_of_points{n_points},
         elastic_constant{k},
@@ -80,7 +102,8 @@ struct settings
         fps{framerate},
         x_formula{std::move(x_formula)},
         y_formula{std::move(y_formula)},
-        equalize_distance{equalize_distance}
+        equalize_distance{equalize_distance},
+        start_at_equilibrium{start_at_equilibrium}
     { }
 };
 
@@ -104,54 +127,127 @@ constexpr auto dt = ph::duration{0.1 * si::second};
 constexpr auto fps = 60 * si::hertz;
 }  // namespace constants
 
+/**
+ * @brief Geometry and pair forces of the segment between two adjacent points.
+ *
+ * The forces are the ones acting on the first endpoint of the segment; by Newton's third law the
+ * second endpoint receives the opposite ones.
+ */
+struct segment
+{
+    ph::position delta;  // x[i] - x[i + 1]
+    ph::length length;  // |delta|
+    ph::direction direction;  // delta / |delta|
+    ph::force elastic;
+    ph::force internal_damping;
+    ph::force external_damping;
+};
+
+/**
+ * @brief Computes the geometry and the pair forces of the segment between two adjacent points
+ *
+ * @param settings the settings from the CLI and UI
+ * @param first the point at index i
+ * @param second the point at index i + 1
+ */
+auto segment_forces(
+    sym::settings const & settings,
+    ph::state const & first,
+    ph::state const & second
+) -> sym::segment;
+
+/**
+ * @brief Assembles the acceleration of a point from the segments it belongs to
+ *
+ * @param settings the settings from the CLI and UI
+ * @param current the point
+ * @param before the segment joining the previous point and `current`, if any
+ * @param after the segment joining `current` and the next point, if any
+ * @param t the current time
+ * @param metadata if not null, filled with the forces acting on the point
+ */
 auto acceleration(
     sym::settings const & settings,
     ph::state const & current,
-    ph::state const * const prev,
-    ph::state const * const next,
+    sym::segment const * const before,
+    sym::segment const * const after,
     [[maybe_unused]] ph::time const t,
     [[maybe_unused]] ph::metadata * metadata = nullptr
 ) -> ph::acceleration;
 
+/**
+ * @brief Computes the segments in [first, last). Each segment is written only by its own index,
+ * so disjoint chunks can be processed concurrently.
+ */
+void segment_pass(
+    sym::settings const & settings,
+    std::span<ph::state const> const states,
+    std::span<sym::segment> const segments,
+    std::ptrdiff_t first,
+    std::ptrdiff_t last
+);
 
-template <std::ranges::random_access_range Derivatives>
-    requires std::convertible_to<
-        std::ranges::range_reference_t<Derivatives>, ph::derivative const &
-    >
-auto evaluate(
+/**
+ * @brief Computes the derivatives of the points in [first, last). Each point only reads the
+ * segments around it, so once the segment pass is complete disjoint chunks can be processed
+ * concurrently.
+ */
+void point_pass(
     sym::settings const & settings,
     std::span<ph::state const> const states,
-    Derivatives && derivatives,
-    int idx,
-    [[maybe_unused]] ph::time t,
+    std::span<sym::segment const> const segments,
+    std::span<ph::derivative> const out,
+    std::ptrdiff_t first,
+    std::ptrdiff_t last,
+    ph::time t,
+    std::span<ph::metadata> const metadata = {}
+);
+
+/**
+ * @brief Computes the state of each point at an intermediate Runge-Kutta stage,
+ * `x + dx * dt` and `v + dv * dt`
+ *
+ * @param states the states at the beginning of the step
+ * @param derivatives the derivatives of the previous stage
+ * @param dt the time offset of the stage
+ * @param out where to write the states of the stage
+ */
+void stage_states(
+    std::span<ph::state const> const states,
+    std::span<ph::derivative const> const derivatives,
     ph::duration dt,
-    ph::metadata * metadata = nullptr
-) -> ph::derivative
-{
-    auto const & curr = states[idx];
-    auto const & d_curr = derivatives[idx];
-    auto const current = ph::state{curr.x + d_curr.dx * dt, curr.v + d_curr.dv * dt, curr.m, curr.fixed};
-
-    auto prev = std::optional<ph::state>{std::nullopt};
-    if (idx > 0) {
-        auto const & s = states[idx - 1];
-        auto const & d = derivatives[idx - 1];
-        prev = ph::state{s.x + d.dx * dt, s.v + d.dv * dt, s.m, s.fixed};
-    }
-
-    auto next = std::optional<ph::state>{std::nullopt};
-    if (idx + 1 < std::ssize(states)) {
-        auto const & s = states[idx + 1];
-        auto const & d = derivatives[idx + 1];
-        next = ph::state{s.x + d.dx * dt, s.v + d.dv * dt, s.m, s.fixed};
-    }
-
-    return ph::derivative{
-        current.v,
-        sym::acceleration(settings, current, prev ? &*prev : nullptr, next ? &*next : nullptr, t, metadata)
-    };
-}
+    std::span<ph::state> const out
+);
 
+/**
+ * @brief Evaluates the derivatives of the whole rope in a given state
+ *
+ * @param settings the settings from the CLI and UI
+ * @param states the states of the points at the current stage
+ * @param segments scratch buffer of `states.size() - 1` segments
+ * @param out where to write the derivatives
+ * @param t the current time
+ * @param metadata if not empty, filled with the forces acting on each point
+ */
+void evaluate(
+    sym::settings const & settings,
+    std::span<ph::state const> const states,
+    std::span<sym::segment> const segments,
+    std::span<ph::derivative> const out,
+    ph::time t,
+    std::span<ph::metadata> const metadata = {}
+);
+
+/**
+ * @brief Integrates a time-step, with a single RK4 step or with the multirate scheme if
+ * `settings.substeps` is greater than one
+ *
+ * @param settings the settings from the CLI and UI
+ * @param states the current state of the rope
+ * @param t the current time
+ * @param dt the time-step
+ * @param save whether to save the metadata
+ */
 auto integrate(
     sym::settings const & settings,
     std::span<ph::state const> const states,
@@ -161,7 +257,135 @@ auto integrate(
 ) -> ph::simulation_data;
 
 /**
- * @brief Construct the rope using a function.
+ * @brief Integrates a time-step like above, writing the result in `out`: once its vectors have the
+ * right capacity, the step does not allocate (for ropes below `sym::parallel_grain` points)
+ *
+ * @param out the new state and, if `save`, the metadata; must not alias `states`
+ */
+void integrate(
+    sym::settings const & settings,
+    std::span<ph::state const> const states,
+    ph::time t,
+    ph::duration dt,
+    ph::simulation_data & out,
+    bool save = false
+);
+
+/**
+ * @brief Integrates a time-step splitting the stiff forces from the soft ones:
+ * half kick of the soft forces, `settings.substeps` RK4 steps of the stiff forces, half kick of
+ * the soft forces. The forces are split according to `settings.substepped`.
+ *
+ * @param settings the settings from the CLI and UI
+ * @param states the current state of the rope
+ * @param t the current time
+ * @param dt the time-step
+ * @param save whether to save the metadata, computed with all the forces at the end of the step
+ */
+auto multirate_integrate(
+    sym::settings const & settings,
+    std::span<ph::state const> const states,
+    ph::time t,
+    ph::duration dt,
+    bool save = false
+) -> ph::simulation_data;
+
+/**
+ * @brief Integrates a multirate time-step like above, writing the result in `out`
+ */
+void multirate_integrate(
+    sym::settings const & settings,
+    std::span<ph::state const> const states,
+    ph::time t,
+    ph::duration dt,
+    ph::simulation_data & out,
+    bool save = false
+);
+
+/**
+ * @brief Estimates the largest time-step for which the Runge-Kutta 4 integration stays stable,
+ * from the stiffest oscillation (neighbouring points moving in opposition) of the elastic and
+ * bending forces and from the fastest damping rate. With the multirate scheme, the stiff forces
+ * limit the substeps and the soft ones the kicks.
+ *
+ * @param settings the settings from the CLI and UI
+ * @param safety the fraction of the estimated limit to return
+ */
+auto stable_timestep(sym::settings const & settings, double safety = 0.5) -> ph::duration;
+
+/**
+ * @brief Computes the mechanical energy of the rope: the kinetic one, plus the potentials of the
+ * enabled forces among the elastic, the gravitational and the bending one
+ *
+ * @param settings the settings from the CLI and UI
+ * @param states the rope
+ */
+auto energy(sym::settings const & settings, std::span<ph::state const> states) -> ph::energy;
+
+/**
+ * @brief Stability watchdog for `guarded_integrate`: a step is rejected if it produces
+ * non-finite values or if the energy of the rope grows too much.
+ */
+struct watchdog
+{
+    double max_energy_growth = 0.05;  // per step, relative to the energy scale of the rope
+    int max_retries = 10;
+    int growth_steps = 16;  // accepted steps before a halved time-step is doubled back
+    int rollbacks = 0;  // number of rejected steps so far
+
+    // the time-step of the user while the watchdog uses a smaller one, and the smaller one
+    ph::duration requested_dt = ph::duration::zero();
+    ph::duration reduced_dt = ph::duration::zero();
+    int accepted = 0;  // accepted steps since the time-step was last changed
+
+    // the energy of the last accepted state, which is the energy before the next step
+    std::optional<ph::energy> energy = std::nullopt;
+    ph::state const * energy_of = nullptr;
+
+    /** Drops the energy of the last accepted state: call it after editing the rope or the settings */
+    void forget() noexcept { energy.reset(); energy_of = nullptr; }
+};
+
+/**
+ * @brief Integrates a step like `integrate`, checking the result with the watchdog. A rejected
+ * step is retried from the same state with half the time-step; the halved time-step is kept in
+ * the settings for the next steps, and doubled back towards the one of the user after
+ * `watchdog.growth_steps` accepted steps. If all the retries fail, the time-step of the user is
+ * restored.
+ *
+ * @param settings the settings from the CLI and UI; `settings.dt` is the time-step to use, and
+ *                 after the call the one actually used
+ * @param states the current state of the rope
+ * @param t the current time
+ * @param watchdog the watchdog parameters and statistics
+ * @param save whether to save the metadata
+ * @return the new state; if all the retries fail, the unchanged state
+ */
+auto guarded_integrate(
+    sym::settings & settings,
+    std::span<ph::state const> const states,
+    ph::time t,
+    sym::watchdog & watchdog,
+    bool save = false
+) -> ph::simulation_data;
+
+/**
+ * @brief Integrates a guarded step like above, writing the result in `out`
+ *
+ * @return whether a step was accepted; if not, `out` holds the unchanged state
+ */
+auto guarded_integrate(
+    sym::settings & settings,
+    std::span<ph::state const> const states,
+    ph::time t,
+    sym::watchdog & watchdog,
+    ph::simulation_data & out,
+    bool save = false
+) -> bool;
+
+/**
+ * @brief Construct the rope using a function. If `settings.start_at_equilibrium` is set, the
+ * rope is then brought to its static equilibrium.
  *
  * @param settings the settings from the CLI and UI.
  * @param f a function mapping [0,1] to a 2D vector.
@@ -170,6 +394,18 @@ auto construct_rope(
     sym::settings const & settings, std::function<ph::vector<>(double)> const & f
 ) -> std::vector<ph::state>;
 
+/**
+ * @brief Construct the rope resampling a polyline at equidistant points, scaled to
+ * `settings.total_length`. If `settings.start_at_equilibrium` is set, the rope is then brought to
+ * its static equilibrium.
+ *
+ * @param settings the settings from the CLI and UI.
+ * @param shape at least two points, with the y axis pointing downwards.
+ */
+auto construct_rope(
+    sym::settings const & settings, std::span<math::vector<double, 2> const> shape
+) -> std::vector<ph::state>;
+
 /**
  * @brief Generates `n_points` points incrementing linearly t in the interval [0, 1]
  *
@@ -195,17 +431,68 @@ auto equidistant_points_along_function(
     std::optional<double> total_len = std::nullopt
 ) -> std::vector<math::vector<double, 2>>;
 
+/** The bounds of x and y of a curve and of their derivatives over an interval of t, the variable */
+using curve_bound = std::function<
+    std::array<brun::expr::dual<brun::expr::interval>, 2>(brun::expr::dual<brun::expr::interval> const &)
+>;
+
+/**
+ * @brief Samples a curve at the values of t in [0, 1] needed to follow it within `tolerance`:
+ * an interval of t is halved until the curve over it provably lies within `tolerance` of the
+ * chord, either because its bounds do or because its derivatives are bounded close to the slope
+ * of the chord. The latter bound shrinks with the square of the interval, and is zero on the
+ * straight stretches, which cost two evaluations.
+ *
+ * @param fn a function mapping [0, 1] into a 2D vector.
+ * @param bound the bounds of `fn` and of its derivative over an interval of t.
+ * @param tolerance the maximum distance between the curve and the returned polyline.
+ * @param max_depth the maximum number of halvings, which stops at the singularities.
+ */
+auto adaptive_points_along_function(
+    std::function<ph::vector<>(double)> const & fn, curve_bound const & bound, double tolerance,
+    int max_depth = 16
+) -> std::vector<math::vector<double, 2>>;
+
+/**
+ * @brief Generates `n_points` points along a polyline, equally spaced along its length. The
+ * points are processed in parallel, so this is fast on polylines with millions of points.
+ *
+ * @param shape the polyline, with at least two points
+ * @param n_points the number of vectors to generate.
+ * @param total_len the total length of the curve
+ * @throw std::invalid_argument if the polyline has no length
+ */
+auto equidistant_points_along_polyline(
+    std::span<math::vector<double, 2> const> shape, ssize_t n_points,
+    std::optional<double> total_len = std::nullopt
+) -> std::vector<math::vector<double, 2>>;
+
+/**
+ * @brief Builds the initial rope from `settings.shape_file` if set or from the formulas otherwise,
+ * at its static equilibrium if `settings.start_at_equilibrium` is set. The shapes and the
+ * equilibria are remembered by `sym::shape_cache::global()`, so building again a recent rope
+ * only copies its positions.
+ *
+ * @param settings the settings from the CLI and UI
+ * @throw std::invalid_argument if a formula cannot be parsed
+ * @throw std::runtime_error if the shape file cannot be read
+ */
+auto initial_rope(sym::settings const & settings) -> std::vector<ph::state>;
+
 /**
- * @brief Resets the rope to a default state
+ * @brief Resets the rope to its initial state, built by `initial_rope`, and the time to
+ * `settings.t0`
  *
  * @param settings the settings from the CLI and UI
  * @param rope a reference to the rope
  * @param metadata a reference to the metadata
  * @param t a reference to the current time
+ * @throw std::invalid_argument if a formula cannot be parsed
+ * @throw std::runtime_error if the shape file cannot be read
  */
 void reset(
     sym::settings & settings,
-    std::vector<ph::state> & rope, std::vector<ph::metadata> & metadata,
+    sym::memory::vector<ph::state> & rope, sym::memory::vector<ph::metadata> & metadata,
     ph::duration & t
 );
 
@@ -0,0 +1,109 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : static_expression
+ * @created     : Tuesday Oct 20, 2026 16:05:12 CEST
+ * @description : expressions parsed at compile time
+ * */
+
+#ifndef BRUN_EXPR_STATIC_EXPRESSION_HPP
+#define BRUN_EXPR_STATIC_EXPRESSION_HPP
+
+#include <expression.hpp>
+#include <parser.hpp>
+#include <evaluate.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace brun::expr
+{
+
+/** A string literal usable as a template argument */
+template <std::size_t N>
+struct fixed_string
+{
+    std::array<char, N> chars{};
+
+    consteval fixed_string(char const (&literal)[N]) { std::ranges::copy(literal, chars.begin()); }  // NOLINT
+
+    [[nodiscard]] constexpr auto view() const noexcept { return std::string_view{chars.data(), N - 1}; }
+};
+
+namespace compile_time
+{
+using parser::ir_node;
+
+// evaluates the node `I` of `Tree`: every node is its own function, so the whole tree is inlined
+template <auto const & Tree, int I, typename T>
+constexpr auto evaluate(T const & x) -> T
+{
+    constexpr auto n = Tree[I];
+    if constexpr (n.type == ir_node::kind::constant) {
+        return T{n.value};
+    } else if constexpr (n.type == ir_node::kind::parameter) {
+        return x;
+    } else if constexpr (parser::is_binary(n.op)) {
+        return apply(n.op, evaluate<Tree, n.left>(x), evaluate<Tree, n.right>(x));
+    } else {
+        return apply(n.op, evaluate<Tree, n.left>(x));
+    }
+}
+}  // namespace compile_time
+
+/**
+ * @brief An expression of one parameter parsed by the compiler
+ *
+ * The source accepts the grammar of `parse_expression`, and gives the same results of
+ * `expression::eval`, but it is parsed during the compilation - a bad formula does not compile -
+ * and every node of the tree is a function template, so the evaluation is inlined as if written
+ * by hand:
+ * @code
+ * constexpr auto y = static_expression<"sin(2*pi*t)/4">{};
+ * auto const value = y(0.3);
+ * @endcode
+ */
+template <fixed_string Source, param_t Param = 't'>
+class static_expression
+{
+    static constexpr auto params = std::array{Param};
+
+    static constexpr auto parse()
+    {
+        auto ir = parser::parse(Source.view(), {params.data(), params.size()});
+        if (not ir) {
+            throw std::invalid_argument{"syntax error"};  // the constant evaluation fails here
+        }
+        return *std::move(ir);
+    }
+
+    static constexpr auto size = parse().size();
+    static constexpr auto tree = [] {
+        auto result = std::array<parser::ir_node, size>{};
+        std::ranges::copy(parse(), result.begin());
+        return result;
+    }();
+
+public:
+    static constexpr auto source = Source.view();
+    static constexpr auto param = Param;
+
+    static constexpr auto operator()(const_t value) -> const_t
+    {
+        return compile_time::evaluate<tree, static_cast<int>(size) - 1>(value);
+    }
+
+    /** Evaluates the expression on another number type, as `apply` */
+    template <typename T>
+    requires (not std::is_arithmetic_v<T>)
+    static constexpr auto operator()(T const & value) -> T
+    {
+        return compile_time::evaluate<tree, static_cast<int>(size) - 1>(value);
+    }
+};
+
+}  // namespace brun::expr
+
+#endif /* BRUN_EXPR_STATIC_EXPRESSION_HPP */
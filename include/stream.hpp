@@ -0,0 +1,89 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : stream
+ * @created     : Sunday Oct 18, 2026 12:10:44 CEST
+ * @description : streaming of the rope to stdout, files or FIFOs
+ * */
+
+#ifndef STREAM_HPP
+#define STREAM_HPP
+
+#include <physics.hpp>
+#include <fmt/format.h>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace sym
+{
+
+/**
+ * @brief Writes selected fields of the rope every few steps, as NDJSON or as little endian binary
+ * frames. The frames are formatted into a buffer which is written in big chunks.
+ *
+ * A binary frame is a 24 bytes header - magic "ROPF", u16 version (1), u16 fields, u32 number of
+ * points, u32 zero, f64 time - followed by the selected fields of each point as f64 pairs, in the
+ * order position, velocity, force. An NDJSON frame is an object with the time "t" and an array
+ * for each selected component ("x", "y", "vx", "vy", "fx", "fy"). Values are in SI units, with
+ * the y axis pointing downwards.
+ */
+class stream_emitter
+{
+public:
+    enum class format : std::uint8_t { ndjson, binary };
+
+    enum field : std::uint16_t { position = 1U << 0U, velocity = 1U << 1U, force = 1U << 2U };
+
+    struct options
+    {
+        format fmt = format::ndjson;
+        std::uint16_t fields = field::position;
+        int every = 1;  // steps between two frames
+    };
+
+    /**
+     * @brief Opens the output
+     *
+     * @param path "-" for stdout, otherwise a file or a FIFO (the call waits for a reader)
+     * @throw std::system_error if the output cannot be opened
+     */
+    stream_emitter(std::string const & path, options opts);
+    ~stream_emitter();
+
+    stream_emitter(stream_emitter const &) = delete;
+    stream_emitter(stream_emitter &&) = delete;
+    auto operator=(stream_emitter const &) -> stream_emitter & = delete;
+    auto operator=(stream_emitter &&) -> stream_emitter & = delete;
+
+    /**
+     * @brief Counts a step, and writes a frame every `options.every` steps
+     *
+     * @param metadata the forces on each point; forces are written as zero if missing
+     * @throw std::system_error if the write fails
+     */
+    void step(ph::time t, std::span<ph::state const> rope, std::span<ph::metadata const> metadata);
+
+    /** Writes the buffered frames */
+    void flush();
+
+private:
+    int _fd;
+    bool _owned;
+    options _options;
+    long _steps = 0;
+    fmt::memory_buffer _buffer;
+
+    void emit(ph::time t, std::span<ph::state const> rope, std::span<ph::metadata const> metadata);
+};
+
+/** Parses a format name: "ndjson" or "binary" */
+auto parse_stream_format(std::string_view name) -> std::expected<stream_emitter::format, std::string>;
+
+/** Parses a comma separated list of fields among "position", "velocity" and "force" */
+auto parse_stream_fields(std::string_view names) -> std::expected<std::uint16_t, std::string>;
+
+}  // namespace sym
+
+#endif /* STREAM_HPP */
@@ -0,0 +1,132 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : trajectory
+ * @created     : Monday Oct 19, 2026 09:14:27 CEST
+ * @description : compressed recording and replay of the rope positions
+ * */
+
+#ifndef TRAJECTORY_HPP
+#define TRAJECTORY_HPP
+
+#include <physics.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+namespace sym
+{
+
+/**
+ * @brief Lossy codec for the rope positions
+ *
+ * Each coordinate is quantized on a grid of step `2 * error_bound`, so that the decoded value is
+ * never further than `error_bound` from the recorded one. A frame stores, for every coordinate,
+ * the change of its quantized value from the previous frame minus the same change of the
+ * previous point: neighbouring points move together, so the residuals are mostly tiny. Keyframes,
+ * every `keyframe_interval` frames, store the difference from the previous point only, and allow
+ * to seek without decoding the whole recording. The residuals are written as zigzag varints,
+ * and the bytes of each frame are coded with an order-0 rANS coder.
+ *
+ * The file is a 32 bytes header - magic "ROPT", u16 version (1), u16 zero, u32 keyframe interval,
+ * u32 zero, f64 quantization step, u64 zero - followed by the frames. A frame is a 24 bytes header
+ * - u32 payload size, u32 number of points, f64 time, u8 keyframe, 7 bytes zero - followed by the
+ * payload. Everything is little endian.
+ */
+struct trajectory_options
+{
+    ph::length error_bound = 1e-6 * ph::m;
+    int keyframe_interval = 64;
+};
+
+/** Records the positions of the rope in a compressed trajectory file */
+class trajectory_writer
+{
+public:
+    /**
+     * @throw std::system_error if the file cannot be opened
+     * @throw std::invalid_argument if the error bound is not positive
+     */
+    trajectory_writer(std::filesystem::path const & path, trajectory_options opts);
+
+    /**
+     * @brief Appends a frame; a frame with a different number of points is a keyframe
+     *
+     * @throw std::system_error if the write fails
+     */
+    void record(ph::time t, std::span<ph::state const> rope);
+
+    /** Writes the buffered frames */
+    void flush();
+
+    [[nodiscard]] auto frames() const noexcept { return _frames; }
+
+    /** The size of the positions as raw doubles, and the size of the compressed frames */
+    [[nodiscard]] auto raw_bytes() const noexcept { return _raw_bytes; }
+    [[nodiscard]] auto compressed_bytes() const noexcept { return _compressed_bytes; }
+
+private:
+    std::ofstream _file;
+    std::filesystem::path _path;
+    double _step;
+    int _keyframe_interval;
+    std::size_t _frames = 0;
+    std::size_t _raw_bytes = 0;
+    std::size_t _compressed_bytes = 0;
+    std::vector<std::int64_t> _previous;
+    std::vector<std::int64_t> _current;
+    std::vector<std::uint8_t> _residuals;
+    std::vector<std::uint8_t> _payload;
+};
+
+/**
+ * @brief Random access to the frames of a trajectory file
+ *
+ * The file is read at once and indexed. Decoding the next frame costs one pass over the points;
+ * a jump decodes from the closest keyframe before the target.
+ */
+class trajectory_reader
+{
+public:
+    /** @throw std::runtime_error if the file cannot be read or is not a trajectory */
+    explicit trajectory_reader(std::filesystem::path const & path);
+
+    [[nodiscard]] auto size() const noexcept { return _frames.size(); }
+    [[nodiscard]] auto error_bound() const noexcept -> ph::length { return _step / 2 * ph::m; }
+    [[nodiscard]] auto time(std::size_t frame) const -> ph::time;
+
+    /**
+     * @brief The positions at the given frame
+     *
+     * The span is valid until the next call.
+     *
+     * @throw std::out_of_range if there is no such frame
+     * @throw std::runtime_error if the frame is corrupted
+     */
+    auto positions(std::size_t frame) -> std::span<ph::position const>;
+
+private:
+    struct frame_info
+    {
+        std::size_t offset;  // of the payload
+        std::uint32_t bytes;
+        std::uint32_t points;
+        double time;
+        bool keyframe;
+    };
+
+    std::vector<std::uint8_t> _data;
+    std::vector<frame_info> _frames;
+    double _step = 0.;
+    std::size_t _decoded = static_cast<std::size_t>(-1);
+    std::vector<std::int64_t> _quantized;
+    std::vector<std::uint8_t> _residuals;
+    std::vector<ph::position> _positions;
+
+    void decode(std::size_t frame);
+};
+
+}  // namespace sym
+
+#endif /* TRAJECTORY_HPP */
@@ -0,0 +1,138 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : allocations
+ * @created     : Saturday Oct 17, 2026 18:58:02 CEST
+ * @description : 
+ */
+
+#include "allocations.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace sym::allocations
+{
+
+namespace
+{
+// Each thread counts in its own slot, so the counters are never shared between cores; they are
+// atomic only to be read from the other threads. The slots are static: allocating them would
+// recurse into operator new.
+constexpr auto max_threads = std::size_t{256};
+
+struct alignas(64) slot
+{
+    std::array<std::atomic<std::uint64_t>, subsystems.size()> allocations{};
+    std::array<std::atomic<std::uint64_t>, subsystems.size()> bytes{};
+};
+
+std::array<slot, max_threads> slots;
+std::atomic<std::size_t> used_slots = 0;
+
+[[maybe_unused]] void record(std::size_t bytes) noexcept
+{
+    // threads past the last slot share it, the counts are still correct
+    thread_local auto & own = slots[std::min(used_slots.fetch_add(1), max_threads - 1)];
+    auto const idx = std::to_underlying(current_subsystem);
+    own.allocations[idx].fetch_add(1, std::memory_order_relaxed);
+    own.bytes[idx].fetch_add(bytes, std::memory_order_relaxed);
+}
+}  // namespace
+
+auto count(subsystem s) noexcept -> counters
+{
+    auto const idx = std::to_underlying(s);
+    auto const n = std::min(used_slots.load(), max_threads);
+    auto result = counters{};
+    for (auto i = 0uz; i < n; ++i) {
+        result.allocations += slots[i].allocations[idx].load(std::memory_order_relaxed);
+        result.bytes += slots[i].bytes[idx].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+auto snapshot() noexcept -> snapshot_t
+{
+    auto result = snapshot_t{};
+    std::ranges::transform(subsystems, result.begin(), count);
+    return result;
+}
+
+void report(std::size_t steps)
+{
+    auto const scale = 1. / static_cast<double>(std::max(steps, std::size_t{1}));
+    fmt::print(stderr, "{:<12} {:>12} {:>16} {:>14} {:>14}\n", "Allocations", "Total", "Total B", "Per step", "B per step");
+    for (auto const s : subsystems) {
+        auto const [n, bytes] = count(s);
+        fmt::print(stderr, "{:<12} {:>12} {:>16} {:>14.3f} {:>14.1f}\n", name(s), n, bytes,
+            static_cast<double>(n) * scale, static_cast<double>(bytes) * scale);
+    }
+}
+
+#ifdef ROPES_COUNT_ALLOCATIONS
+namespace
+{
+auto allocate(std::size_t size) noexcept -> void *
+{
+    record(size);
+    return std::malloc(std::max(size, std::size_t{1}));  // NOLINT(*-no-malloc)
+}
+
+auto allocate(std::size_t size, std::align_val_t alignment) noexcept -> void *
+{
+    record(size);
+    auto const align = std::max(static_cast<std::size_t>(alignment), sizeof(void *));
+    // aligned_alloc wants a multiple of the alignment
+    return std::aligned_alloc(align, std::max((size + align - 1) / align * align, align));
+}
+
+template <typename ...Args>
+auto allocate_or_throw(Args ...args) -> void *
+{
+    auto * const ptr = allocate(args...);
+    if (ptr == nullptr) {
+        throw std::bad_alloc{};
+    }
+    return ptr;
+}
+}  // namespace
+#endif
+
+}  // namespace sym::allocations
+
+#ifdef ROPES_COUNT_ALLOCATIONS
+// NOLINTBEGIN(*-no-malloc)
+using sym::allocations::allocate;
+using sym::allocations::allocate_or_throw;
+
+auto operator new(std::size_t size) -> void * { return allocate_or_throw(size); }
+auto operator new[](std::size_t size) -> void * { return allocate_or_throw(size); }
+auto operator new(std::size_t size, std::align_val_t al) -> void * { return allocate_or_throw(size, al); }
+auto operator new[](std::size_t size, std::align_val_t al) -> void * { return allocate_or_throw(size, al); }
+auto operator new(std::size_t size, std::nothrow_t const &) noexcept -> void * { return allocate(size); }
+auto operator new[](std::size_t size, std::nothrow_t const &) noexcept -> void * { return allocate(size); }
+auto operator new(std::size_t size, std::align_val_t al, std::nothrow_t const &) noexcept -> void *
+{
+    return allocate(size, al);
+}
+auto operator new[](std::size_t size, std::align_val_t al, std::nothrow_t const &) noexcept -> void *
+{
+    return allocate(size, al);
+}
+
+void operator delete(void * ptr) noexcept { std::free(ptr); }
+void operator delete[](void * ptr) noexcept { std::free(ptr); }
+void operator delete(void * ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void * ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void * ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void * ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void * ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void * ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void * ptr, std::nothrow_t const &) noexcept { std::free(ptr); }
+void operator delete[](void * ptr, std::nothrow_t const &) noexcept { std::free(ptr); }
+void operator delete(void * ptr, std::align_val_t, std::nothrow_t const &) noexcept { std::free(ptr); }
+void operator delete[](void * ptr, std::align_val_t, std::nothrow_t const &) noexcept { std::free(ptr); }
+// NOLINTEND(*-no-malloc)
+#endif
@@ -0,0 +1,83 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : buffer
+ * @created     : Saturday Oct 17, 2026 17:30:05 CEST
+ * @description : 
+ */
+
+#include "buffer.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <numeric>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace sym::memory
+{
+
+bool use_huge_pages = false;
+
+namespace
+{
+auto page_aligned(std::size_t bytes) noexcept
+{
+    return bytes >= huge_page_size;
+}
+}  // namespace
+
+auto allocate(std::size_t bytes, std::size_t alignment) -> void *
+{
+    if (not page_aligned(bytes)) {
+        return ::operator new(bytes, std::align_val_t{alignment});
+    }
+    // aligned_alloc wants a multiple of the alignment
+    auto const size = (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+    auto * const ptr = std::aligned_alloc(huge_page_size, size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc{};
+    }
+#ifdef MADV_HUGEPAGE
+    if (use_huge_pages) {
+        // only a hint: without transparent huge pages the memory is still usable
+        ::madvise(ptr, size, MADV_HUGEPAGE);
+    }
+#endif
+    return ptr;
+}
+
+void release(void * ptr, std::size_t bytes, std::size_t alignment) noexcept
+{
+    if (not page_aligned(bytes)) {
+        ::operator delete(ptr, bytes, std::align_val_t{alignment});
+        return;
+    }
+    std::free(ptr);  // NOLINT(*-no-malloc)
+}
+
+auto first_touch_grain(std::size_t bytes, std::size_t size) noexcept -> std::ptrdiff_t
+{
+    if (not use_huge_pages or not page_aligned(bytes)) {
+        return sym::parallel_grain;
+    }
+    // the fewest elements that fill whole huge pages, so that no page is shared by two chunks
+    return static_cast<std::ptrdiff_t>(huge_page_size / std::gcd(huge_page_size, size));
+}
+
+void first_touch(void * ptr, std::size_t bytes, std::size_t size, sym::scheduler & pool)
+{
+    // smaller allocations share their pages with the rest of the heap
+    if (not page_aligned(bytes)) {
+        return;
+    }
+    auto * const data = static_cast<std::byte *>(ptr);
+    auto const count = static_cast<std::ptrdiff_t>(bytes / size);
+    pool.parallel_for(0, count, first_touch_grain(bytes, size), [data, size](auto first, auto last) {
+        std::memset(data + first * size, 0, static_cast<std::size_t>(last - first) * size);
+    });
+}
+
+}  // namespace sym::memory
@@ -0,0 +1,269 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : calibration
+ * @created     : Friday Oct 23, 2026 10:41:20 CEST
+ * @description :
+ */
+
+#include "calibration.hpp"
+#include "scheduler.hpp"
+#include "allocations.hpp"
+#include <fmt/format.h>
+#include <mp-units/math.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <ranges>
+#include <stdexcept>
+
+namespace sym
+{
+
+namespace
+{
+constexpr auto infinity = std::numeric_limits<double>::infinity();
+
+struct parameter_info
+{
+    calibration_options::parameter flag;
+    std::string_view name;
+    double (*get)(sym::settings const &);  // in the units of the CLI
+    void (*set)(sym::settings &, double);
+};
+
+constexpr auto parameters = std::array{
+    parameter_info{
+        calibration_options::elastic_constant, "k",
+        [](sym::settings const & s) { return s.elastic_constant.numerical_value_in(ph::N / ph::m); },
+        [](sym::settings & s, double value) { s.elastic_constant = value * ph::N / ph::m; }
+    },
+    parameter_info{
+        calibration_options::young_modulus, "E",
+        [](sym::settings const & s) { return s.young_modulus.numerical_value_in(ph::GPa); },
+        [](sym::settings & s, double value) { s.young_modulus = value * ph::GPa; }
+    },
+    parameter_info{
+        calibration_options::external_damping, "b",
+        [](sym::settings const & s) { return s.external_damping.numerical_value_in(ph::N * ph::s / ph::m); },
+        [](sym::settings & s, double value) { s.external_damping = value * ph::N * ph::s / ph::m; }
+    },
+    parameter_info{
+        calibration_options::internal_damping, "c",
+        [](sym::settings const & s) { return s.internal_damping.numerical_value_in(ph::N * ph::s / ph::m); },
+        [](sym::settings & s, double value) { s.internal_damping = value * ph::N * ph::s / ph::m; }
+    },
+};
+
+/** The frames of the reference compared with the simulations, decoded once for all of them */
+struct reference_samples
+{
+    std::vector<ph::time> times;
+    std::vector<std::vector<ph::position>> positions;
+};
+
+auto sample(sym::trajectory_reader & reference, int samples) -> reference_samples
+{
+    auto const frames = reference.size();
+    auto const n = std::clamp(static_cast<std::size_t>(std::max(samples, 2)), 2uz, frames);
+    auto result = reference_samples{};
+    for (auto i = 0uz; i < n; ++i) {
+        auto const frame = i * (frames - 1) / (n - 1);
+        auto const positions = reference.positions(frame);
+        result.times.push_back(reference.time(frame));
+        result.positions.emplace_back(positions.begin(), positions.end());
+    }
+    return result;
+}
+
+// the rope of the simulation, moved to the first frame of the reference
+auto starting_rope(sym::settings const & settings, sym::trajectory_reader & reference) -> std::vector<ph::state>
+{
+    auto rope = sym::initial_rope(settings);
+    auto const frame = reference.positions(0);
+    auto const first = std::vector<ph::position>(frame.begin(), frame.end());
+    auto const second = reference.positions(1);
+    if (first.size() != rope.size() or second.size() != rope.size()) {
+        throw std::invalid_argument{fmt::format(
+            "the reference has {} points, the simulation {}", first.size(), rope.size()
+        )};
+    }
+    auto const dt = reference.time(1) - reference.time(0);
+    for (auto && [s, x0, x1] : std::views::zip(rope, first, second)) {
+        s.x = x0;
+        s.v = (x1 - x0) / dt;
+    }
+    return rope;
+}
+
+// the number of equal steps of at most `dt` covering `span`
+auto steps_over(ph::duration span, ph::duration dt) -> int
+{
+    return std::max(1, static_cast<int>(std::ceil((span / dt).numerical_value_in(mp_units::one))));
+}
+
+/**
+ * The RMS distance in m of the points of the simulation from the reference, or infinity as soon
+ * as it is certainly larger than `threshold`
+ */
+auto position_rms(
+    sym::settings const & settings, std::span<ph::state const> start, reference_samples const & reference,
+    double threshold
+) -> double
+{
+    auto rope = sym::memory::vector<ph::state>(start.begin(), start.end());
+    auto step = ph::simulation_data{};
+    auto const count = static_cast<double>((reference.times.size() - 1) * rope.size());
+    auto const budget = threshold * threshold * count;
+    auto sum = 0.;
+    for (auto j = 1uz; j < reference.times.size(); ++j) {
+        auto const t = reference.times[j - 1];
+        auto const span = reference.times[j] - t;
+        auto const steps = steps_over(span, settings.dt);
+        auto const h = span / steps;
+        for (auto i = 0; i < steps; ++i) {
+            sym::integrate(settings, rope, t + i * h, h, step);
+            std::swap(rope, step.state);
+        }
+        for (auto && [s, x] : std::views::zip(rope, reference.positions[j])) {
+            sum += math::squared_norm(s.x - x).numerical_value_in(ph::m * ph::m);
+        }
+        // the sum only grows, and is NaN if the simulation diverged
+        if (not (sum <= budget)) {
+            return infinity;
+        }
+    }
+    return std::sqrt(sum / count);
+}
+
+/** A point of the simplex: the logarithms of the parameters, and their loss */
+struct vertex
+{
+    std::vector<double> x;
+    double loss = infinity;
+};
+}  // namespace
+
+auto calibrate(
+    sym::settings const & settings, sym::trajectory_reader & reference, sym::calibration_options const & options
+) -> sym::calibration_result
+{
+    auto const accounting = sym::allocations::scope{sym::allocations::subsystem::simulation};
+    auto const fitted = parameters
+        | std::views::filter([&](auto const & p) { return (options.parameters & p.flag) != 0; })
+        | std::ranges::to<std::vector>();
+    if (fitted.empty()) {
+        throw std::invalid_argument{"no parameter to calibrate"};
+    }
+    for (auto const & p : fitted) {
+        if (not (p.get(settings) > 0.)) {
+            throw std::invalid_argument{fmt::format(
+                "cannot calibrate {} starting from {}: give it a positive initial guess", p.name, p.get(settings)
+            )};
+        }
+    }
+    if (reference.size() < 2) {
+        throw std::invalid_argument{"the reference needs at least two frames"};
+    }
+    auto const samples = sample(reference, options.samples);
+    auto const start = starting_rope(settings, reference);
+
+    // the parameters span orders of magnitude, and must stay positive
+    auto const candidate = [&](std::vector<double> const & x) {
+        auto result = settings;
+        for (auto const & [p, log_value] : std::views::zip(fitted, x)) {
+            p.set(result, std::exp(log_value));
+        }
+        return result;
+    };
+
+    auto result = sym::calibration_result{settings, ph::length::zero()};
+    auto & pool = sym::scheduler::global();
+    auto const evaluate = [&](std::span<vertex> vertices, double threshold) {
+        pool.parallel_for(0, std::ssize(vertices), 1, [&](auto first, auto last) {
+            for (auto i = first; i < last; ++i) {
+                vertices[i].loss = position_rms(candidate(vertices[i].x), start, samples, threshold);
+            }
+        });
+        result.evaluations += static_cast<int>(vertices.size());
+        result.aborted += static_cast<int>(std::ranges::count(vertices, infinity, &vertex::loss));
+    };
+
+    auto const d = fitted.size();
+    auto simplex = std::vector<vertex>(d + 1, vertex{
+        fitted | std::views::transform([&](auto const & p) { return std::log(p.get(settings)); })
+            | std::ranges::to<std::vector>()
+    });
+    for (auto i = 0uz; i < d; ++i) {
+        simplex[i + 1].x[i] += options.initial_step;
+    }
+    evaluate(simplex, infinity);
+
+    // the centroid of the others, plus `factor` times the distance of the worst vertex from it
+    auto const along = [&](std::vector<double> const & centroid, double factor) {
+        auto const & worst = simplex.back().x;
+        return vertex{std::views::zip_transform(
+            [factor](double c, double w) { return c + factor * (c - w); }, centroid, worst
+        ) | std::ranges::to<std::vector>()};
+    };
+
+    while (result.evaluations < options.max_evaluations) {
+        std::ranges::sort(simplex, {}, &vertex::loss);
+        auto const & best = simplex.front();
+        auto & worst = simplex.back();
+        if (worst.loss - best.loss <= options.tolerance * best.loss) {
+            result.converged = true;
+            break;
+        }
+
+        auto centroid = std::vector<double>(d, 0.);
+        for (auto const & v : simplex | std::views::take(d)) {
+            for (auto i = 0uz; i < d; ++i) {
+                centroid[i] += v.x[i] / static_cast<double>(d);
+            }
+        }
+        // all the moves at once: a simulation that cannot beat the worst vertex is useless in every case
+        auto trials = std::array{along(centroid, 1.), along(centroid, 2.), along(centroid, 0.5), along(centroid, -0.5)};
+        evaluate(trials, worst.loss);
+        auto const & [reflection, expansion, outside, inside] = trials;
+
+        if (reflection.loss < best.loss) {
+            worst = expansion.loss < reflection.loss ? expansion : reflection;
+        } else if (reflection.loss < simplex[d - 1].loss) {
+            worst = reflection;
+        } else if (reflection.loss < worst.loss and outside.loss <= reflection.loss) {
+            worst = outside;
+        } else if (reflection.loss >= worst.loss and inside.loss < worst.loss) {
+            worst = inside;
+        } else {
+            // no move improves the worst vertex: shrink the simplex towards the best one
+            for (auto & v : simplex | std::views::drop(1)) {
+                for (auto i = 0uz; i < d; ++i) {
+                    v.x[i] = best.x[i] + (v.x[i] - best.x[i]) / 2.;
+                }
+            }
+            evaluate(std::span{simplex}.subspan(1), infinity);
+        }
+    }
+
+    auto const & best = std::ranges::min(simplex, {}, &vertex::loss);
+    result.settings = candidate(best.x);
+    result.loss = best.loss * ph::m;
+    return result;
+}
+
+auto parse_calibrated_parameters(std::string_view names) -> std::expected<std::uint8_t, std::string>
+{
+    auto result = std::uint8_t{0};
+    for (auto const name : names | std::views::split(',')) {
+        auto const parameter = std::string_view{name};
+        auto const it = std::ranges::find(parameters, parameter, &parameter_info::name);
+        if (it == parameters.end()) {
+            return std::unexpected{fmt::format("unknown parameter '{}': use k, E, b or c", parameter)};
+        }
+        result = static_cast<std::uint8_t>(result | it->flag);
+    }
+    return result;
+}
+
+}  // namespace sym
@@ -0,0 +1,53 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : engine
+ * @created     : Sunday Oct 18, 2026 11:24:50 CEST
+ * @description : 
+ */
+
+#include "engine.hpp"
+#include <stdexcept>
+
+namespace sym
+{
+
+engine::engine(sym::settings settings, bool save_metadata)
+    : _settings{std::move(settings)}, _t{_settings.t0}, _save_metadata{save_metadata}
+{
+    reset();
+}
+
+engine::engine(sym::settings settings, std::span<ph::state const> rope, bool save_metadata)
+    : _settings{std::move(settings)}, _rope(rope.begin(), rope.end()), _t{_settings.t0}, _save_metadata{save_metadata}
+{
+    if (_rope.empty()) {
+        throw std::invalid_argument{"engine: the rope has no points"};
+    }
+}
+
+void engine::step(int n)
+{
+    for (auto i = 0; i < n; ++i) {
+        if (not sym::guarded_integrate(_settings, _rope, _t, _watchdog, _next, _save_metadata)) {
+            return;  // the state is unchanged, and so is the time
+        }
+        std::swap(_rope, _next.state);
+        std::swap(_metadata, _next.metadata);
+        _t += _settings.dt;  // the time-step actually used, if the watchdog halved it
+    }
+}
+
+void engine::update(sym::settings const & settings)
+{
+    _settings = settings;
+    _watchdog.forget();
+}
+
+void engine::reset()
+{
+    sym::reset(_settings, _rope, _metadata, _t);
+    _next = {};
+    _watchdog.forget();
+}
+
+}  // namespace sym
@@ -0,0 +1,220 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : ensemble
+ * @created     : Saturday Oct 17, 2026 15:21:40 CEST
+ * @description : 
+ */
+
+#include "ensemble.hpp"
+#include "scheduler.hpp"
+#include <mp-units/math.h>
+#include <algorithm>
+#include <numbers>
+#include <stdexcept>
+#include <cmath>
+
+namespace sym
+{
+
+namespace
+{
+// the components of a point, to apply the same operation to all of them
+constexpr auto components = std::array{
+    &ensemble::point::x, &ensemble::point::y, &ensemble::point::vx, &ensemble::point::vy
+};
+}  // namespace
+
+ensemble::ensemble(
+    std::span<sym::settings const> settings, std::span<std::vector<ph::state> const> ropes
+) : _n_points{0}, _n_ropes{ropes.size()}
+{
+    if (ropes.empty() or settings.size() != ropes.size()) {
+        throw std::invalid_argument{"ensemble: expected one settings for each rope"};
+    }
+    _n_points = std::ssize(ropes.front());
+    if (not std::ranges::all_of(ropes, [this](auto const & r) { return std::ssize(r) == _n_points; })) {
+        throw std::invalid_argument{"ensemble: all the ropes must have the same number of points"};
+    }
+
+    auto const g = (1. * mp_units::si::standard_gravity).numerical_value_in(ph::m / ph::s2);
+    auto const n_points = static_cast<std::size_t>(_n_points);
+    _blocks.resize((_n_ropes + width - 1) / width);
+    for (auto b = 0uz; b < _blocks.size(); ++b) {
+        auto & blk = _blocks[b];
+        blk.m.resize(n_points);
+        blk.free.resize(n_points);
+        blk.state.resize(n_points);
+        blk.stage.resize(n_points);
+        for (auto & d : blk.derivatives) {
+            d.resize(n_points);
+        }
+        blk.segments.resize(n_points);
+
+        for (auto lane = 0uz; lane < width; ++lane) {
+            // the lanes past the last rope replicate it, to keep the kernel free of special cases
+            auto const idx = std::min(b * width + lane, _n_ropes - 1);
+            auto const & s = settings[idx];
+            auto const r = s.diameter.numerical_value_in(ph::m) / 2;
+            auto const I = std::numbers::pi * r * r * r * r / 4;
+            blk.k[lane] = s.enabled.elastic ? s.elastic_constant.numerical_value_in(ph::N / ph::m) : 0.;
+            blk.b[lane] = s.enabled.external_damping
+                ? s.external_damping.numerical_value_in(ph::N * ph::s / ph::m) : 0.;
+            blk.c[lane] = s.enabled.internal_damping
+                ? s.internal_damping.numerical_value_in(ph::N * ph::s / ph::m) : 0.;
+            blk.EI[lane] = s.enabled.flexural_rigidity ? s.young_modulus.numerical_value_in(ph::Pa) * I : 0.;
+            blk.g[lane] = s.enabled.gravity ? g : 0.;
+            blk.l[lane] = s.segment_length.numerical_value_in(ph::m);
+
+            for (auto i = 0uz; i < n_points; ++i) {
+                auto const & p = ropes[idx][i];
+                blk.m[i][lane] = p.m.numerical_value_in(ph::kg);
+                blk.free[i][lane] = p.fixed ? 0. : 1.;
+                blk.state[i].x[lane] = p.x[0].numerical_value_in(ph::m);
+                blk.state[i].y[lane] = p.x[1].numerical_value_in(ph::m);
+                blk.state[i].vx[lane] = p.v[0].numerical_value_in(ph::m / ph::s);
+                blk.state[i].vy[lane] = p.v[1].numerical_value_in(ph::m / ph::s);
+            }
+        }
+    }
+}
+
+// Same forces of `sym::segment_forces` and `sym::acceleration`, on plain doubles; the innermost
+// loops run over the lanes, with no dependencies between them
+void ensemble::evaluate(block & blk, std::span<point const> states, std::span<point> out) noexcept
+{
+    auto const n = std::ssize(states);
+    auto & segments = blk.segments;
+
+    for (auto i = 0z; i + 1 < n; ++i) {
+        auto const & p = states[i];
+        auto const & q = states[i + 1];
+        auto & seg = segments[i];
+        for (auto l = 0uz; l < width; ++l) {
+            auto const dx = p.x[l] - q.x[l];
+            auto const dy = p.y[l] - q.y[l];
+            auto const length = std::sqrt(dx * dx + dy * dy);
+            auto const tx = dx / length;
+            auto const ty = dy / length;
+            auto const dvx = p.vx[l] - q.vx[l];
+            auto const dvy = p.vy[l] - q.vy[l];
+
+            auto const k = length < 0.0001 ? 0. : blk.k[l];
+            auto const radial = dvx * tx + dvy * ty;
+            auto const tangential = dvx * ty - dvy * tx;  // along (ty, -tx)
+            seg.tx[l] = tx;
+            seg.ty[l] = ty;
+            seg.length[l] = length;
+            seg.fx[l] = -k * (dx - blk.l[l] * tx) - blk.c[l] * radial * tx - blk.b[l] * tangential * ty;
+            seg.fy[l] = -k * (dy - blk.l[l] * ty) - blk.c[l] * radial * ty + blk.b[l] * tangential * tx;
+        }
+    }
+
+    for (auto i = 0z; i < n; ++i) {
+        auto const & p = states[i];
+        auto & d = out[i];
+        auto const & m = blk.m[i];
+        auto fx = lanes{};
+        auto fy = lanes{};
+        for (auto l = 0uz; l < width; ++l) {
+            fy[l] = m[l] * blk.g[l];
+        }
+        if (i > 0) {
+            auto const & before = segments[i - 1];
+            for (auto l = 0uz; l < width; ++l) {
+                fx[l] -= before.fx[l];
+                fy[l] -= before.fy[l];
+            }
+        }
+        if (i + 1 < n) {
+            auto const & after = segments[i];
+            for (auto l = 0uz; l < width; ++l) {
+                fx[l] += after.fx[l];
+                fy[l] += after.fy[l];
+            }
+        }
+        if (i > 0 and i + 1 < n) {
+            // bending, from the turning angle θ between the two segments
+            auto const & before = segments[i - 1];
+            auto const & after = segments[i];
+            for (auto l = 0uz; l < width; ++l) {
+                auto const sin_θ = before.tx[l] * after.ty[l] - before.ty[l] * after.tx[l];
+                auto const cos_θ = before.tx[l] * after.tx[l] + before.ty[l] * after.ty[l];
+                auto const tan_half_θ = sin_θ / std::max(1 + cos_θ, 1e-12);
+                auto const Δs = (before.length[l] + after.length[l]) / 2;
+                auto const magnitude = -blk.EI[l] / (Δs * Δs) * tan_half_θ;
+                fx[l] -= magnitude * (before.ty[l] + after.ty[l]);
+                fy[l] += magnitude * (before.tx[l] + after.tx[l]);
+            }
+        }
+        auto const & free = blk.free[i];
+        for (auto l = 0uz; l < width; ++l) {
+            d.x[l] = p.vx[l];
+            d.y[l] = p.vy[l];
+            d.vx[l] = fx[l] * free[l] / m[l];
+            d.vy[l] = fy[l] * free[l] / m[l];
+        }
+    }
+}
+
+void ensemble::step(block & blk, double dt) noexcept
+{
+    auto & [k1, k2, k3, k4] = blk.derivatives;
+    auto const advance = [&blk](std::span<point const> derivative, double h) {
+        for (auto i = 0uz; i < blk.state.size(); ++i) {
+            for (auto member : components) {
+                for (auto l = 0uz; l < width; ++l) {
+                    (blk.stage[i].*member)[l] = (blk.state[i].*member)[l] + (derivative[i].*member)[l] * h;
+                }
+            }
+        }
+    };
+
+    evaluate(blk, blk.state, k1);
+    advance(k1, dt / 2);
+    evaluate(blk, blk.stage, k2);
+    advance(k2, dt / 2);
+    evaluate(blk, blk.stage, k3);
+    advance(k3, dt);
+    evaluate(blk, blk.stage, k4);
+
+    for (auto i = 0uz; i < blk.state.size(); ++i) {
+        for (auto member : components) {
+            for (auto l = 0uz; l < width; ++l) {
+                auto const sum = (k1[i].*member)[l] + 2 * (k2[i].*member)[l]
+                    + 2 * (k3[i].*member)[l] + (k4[i].*member)[l];
+                (blk.state[i].*member)[l] += sum * dt / 6;
+            }
+        }
+    }
+}
+
+void ensemble::step(ph::duration dt)
+{
+    auto const h = dt.numerical_value_in(ph::s);
+    // the blocks are independent, a few per task to amortize the scheduling
+    sym::scheduler::global().parallel_for(0, std::ssize(_blocks), 8, [this, h](auto first, auto last) {
+        for (auto i = first; i < last; ++i) {
+            step(_blocks[static_cast<std::size_t>(i)], h);
+        }
+    });
+}
+
+auto ensemble::rope(std::size_t idx) const -> std::vector<ph::state>
+{
+    auto const & blk = _blocks.at(idx / width);
+    auto const lane = idx % width;
+    auto rope = std::vector<ph::state>{};
+    rope.reserve(blk.state.size());
+    for (auto i = 0uz; i < blk.state.size(); ++i) {
+        auto const & p = blk.state[i];
+        rope.push_back(ph::state{
+            .x = ph::position{p.x[lane] * ph::m, p.y[lane] * ph::m},
+            .v = ph::velocity{p.vx[lane] * ph::m / ph::s, p.vy[lane] * ph::m / ph::s},
+            .m = blk.m[i][lane] * ph::kg,
+            .fixed = blk.free[i][lane] == 0.
+        });
+    }
+    return rope;
+}
+
+}  // namespace sym
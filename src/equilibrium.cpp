@@ -0,0 +1,268 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : equilibrium
+ * @created     : Saturday Oct 17, 2026 10:33:52 CEST
+ * @description : 
+ */
+
+#include "equilibrium.hpp"
+#include <mp-units/math.h>
+#include <algorithm>
+#include <ranges>
+#include <cmath>
+
+namespace sym
+{
+
+namespace
+{
+// the acceleration of a point only depends on the point itself and on its first neighbours
+constexpr auto colors = std::ptrdiff_t{3};
+// distance from the diagonal of the non-zero elements of the jacobian: (xᵢ, yᵢ) vs (xᵢ₊₁, yᵢ₊₁)
+constexpr auto bandwidth = std::ptrdiff_t{3};
+
+auto standard_gravity() -> double
+{
+    return (1. * mp_units::si::standard_gravity).numerical_value_in(ph::m / ph::s2);
+}
+
+/**
+ * Evaluates the accelerations of the rope as a flat array (a₀ₓ, a₀ᵧ, a₁ₓ, a₁ᵧ, ...) in m/s²,
+ * reusing the buffers across calls
+ */
+struct residual_fn
+{
+    sym::settings const * settings;
+    std::vector<sym::segment> segments;
+    std::vector<ph::derivative> derivatives;
+
+    explicit residual_fn(sym::settings const & settings, std::size_t n_points) :
+        settings{std::addressof(settings)},
+        segments(n_points == 0 ? 0 : n_points - 1),
+        derivatives(n_points)
+    {}
+
+    void operator()(std::span<ph::state const> const states, std::span<double> const out)
+    {
+        sym::evaluate(*settings, states, segments, derivatives, settings->t0);
+        for (auto i = 0uz; i < derivatives.size(); ++i) {
+            auto const & dv = derivatives[i].dv;
+            out[2 * i] = dv[0].numerical_value_in(ph::m / ph::s2);
+            out[2 * i + 1] = dv[1].numerical_value_in(ph::m / ph::s2);
+        }
+    }
+};
+
+auto squared_norm(std::span<double const> const v) -> double
+{
+    return std::ranges::fold_left(v | std::views::transform([](double x) { return x * x; }), 0., std::plus{});
+}
+
+auto max_norm(std::span<double const> const v) -> double
+{
+    return std::ranges::fold_left(
+        v | std::views::transform([](double x) { return std::abs(x); }),
+        0., [](double a, double b) { return std::max(a, b); }
+    );
+}
+}  // namespace
+
+auto acceleration_jacobian(
+    sym::settings const & settings, std::span<ph::state const> const states
+) -> math::banded_matrix<double>
+{
+    auto const n = std::ssize(states);
+    auto jacobian = math::banded_matrix<double>(2 * n, bandwidth);
+    auto const h = 1e-6 * settings.segment_length.numerical_value_in(ph::m);
+
+    auto residual = residual_fn{settings, states.size()};
+    auto perturbed = states | std::ranges::to<std::vector>();
+    auto plus = std::vector<double>(2 * states.size());
+    auto minus = std::vector<double>(2 * states.size());
+
+    for (auto color = std::ptrdiff_t{0}; color < colors; ++color) {
+        for (auto c = 0; c < 2; ++c) {
+            auto shift = [&](double amount) {
+                for (auto j = color; j < n; j += colors) {
+                    if (not states[j].fixed) {
+                        perturbed[j].x[c] = states[j].x[c] + amount * ph::m;
+                    }
+                }
+            };
+            shift(h);
+            residual(perturbed, plus);
+            shift(-h);
+            residual(perturbed, minus);
+            shift(0.);
+
+            for (auto i = std::ptrdiff_t{0}; i < n; ++i) {
+                // the only point of this color among i - 1, i and i + 1
+                auto const d = ((color - i) % colors + colors) % colors;
+                auto const j = i + (d == 2 ? -1 : d);
+                if (j < 0 or j >= n or states[j].fixed) {
+                    continue;
+                }
+                for (auto ic = 0; ic < 2; ++ic) {
+                    auto const row = 2 * i + ic;
+                    jacobian(row, 2 * j + c) = (plus[row] - minus[row]) / (2 * h);
+                }
+            }
+        }
+    }
+    return jacobian;
+}
+
+auto catenary(
+    ph::vector<> const & from, ph::vector<> const & to, double length, std::ptrdiff_t n_points
+) -> std::vector<ph::vector<>>
+{
+    auto const chord = math::norm(to - from);
+    auto const h = std::abs(to[0] - from[0]);
+    auto const at = [n_points](auto i) { return static_cast<double>(i) / static_cast<double>(n_points - 1); };
+
+    if (length <= chord or h < 1e-9 * length) {
+        return std::views::iota(std::ptrdiff_t{0}, n_points)
+            | std::views::transform([&](auto i) { return from + (to - from) * at(i); })
+            | std::ranges::to<std::vector>();
+    }
+
+    // With y pointing upwards and `from` in the origin, y(x) = a·cosh((x - x₀) / a) + const.
+    // The parameter a solves √(L² - v²) = 2a·sinh(h / 2a): bisect on ξ = h / 2a
+    auto const v = from[1] - to[1];
+    auto const ratio = std::sqrt(length * length - v * v) / h;
+    auto const sinhc = [](double ξ) { return std::sinh(ξ) / ξ; };
+    auto lo = 0.;
+    auto hi = 1.;
+    while (sinhc(hi) < ratio) {
+        lo = hi;
+        hi *= 2;
+    }
+    for (auto i = 0; i < 100; ++i) {
+        auto const mid = (lo + hi) / 2;
+        (sinhc(mid) < ratio ? lo : hi) = mid;
+    }
+    auto const a = h / (lo + hi);
+    auto const x0 = h / 2 - a * std::atanh(v / length);  // the lowest point
+    auto const s0 = a * std::sinh(-x0 / a);  // signed arc length from the lowest point to `from`
+    auto const y0 = a * std::cosh(-x0 / a);
+    auto const direction = to[0] >= from[0] ? 1. : -1.;
+
+    return std::views::iota(std::ptrdiff_t{0}, n_points)
+        | std::views::transform([=](auto i) {
+            auto const s = s0 + length * at(i);
+            auto const x = x0 + a * std::asinh(s / a);
+            auto const y = a * std::cosh((x - x0) / a) - y0;
+            return from + ph::vector<>{direction * x, -y};
+        })
+        | std::ranges::to<std::vector>();
+}
+
+auto static_equilibrium(
+    sym::settings const & settings, std::span<ph::state const> const rope,
+    int max_iterations, double tolerance
+) -> std::vector<ph::state>
+{
+    auto const n = std::ssize(rope);
+    auto states = rope | std::ranges::to<std::vector>();
+    for (auto & s : states) {
+        s.v = ph::velocity::zero();
+    }
+    auto const fixed = std::views::iota(std::ptrdiff_t{0}, n)
+        | std::views::filter([rope](auto i) { return rope[i].fixed; })
+        | std::ranges::to<std::vector>();
+    if (fixed.empty()) {
+        fmt::print(stderr, "Static equilibrium: the rope has no fixed point\n");
+        return states;
+    }
+
+    /** Initial guess **/
+    auto const g = standard_gravity();
+    auto const l = settings.segment_length.numerical_value_in(ph::m);
+    auto const numerical = [](ph::position const & x) { return x.transform(ph::numerical_value_in(ph::m)); };
+    if (fixed.size() == 2 and fixed.front() == 0 and fixed.back() == n - 1) {
+        auto const total_length = l * static_cast<double>(n - 1);
+        auto const points = sym::catenary(numerical(states.front().x), numerical(states.back().x), total_length, n);
+        for (auto i = 0z; i < n; ++i) {
+            states[i].x = points[i] * ph::m;
+        }
+    } else if (fixed.size() == 1) {
+        // hanging straight down, each segment stretched by the weight below it
+        auto const f = fixed.front();
+        auto const origin = numerical(states[f].x);
+        auto const k = settings.elastic_constant.numerical_value_in(ph::N / ph::m);
+        auto const weight = settings.enabled.gravity ? settings.segment_mass.numerical_value_in(ph::kg) * g : 0.;
+        for (auto const side : {std::ptrdiff_t{-1}, std::ptrdiff_t{1}}) {
+            auto depth = 0.;
+            for (auto i = f + side; i >= 0 and i < n; i += side) {
+                auto const below = static_cast<double>(side > 0 ? n - i : i + 1);
+                depth += l + (settings.enabled.elastic and k > 0 ? below * weight / k : 0.);
+                states[i].x = (origin + ph::vector<>{0., depth}) * ph::m;
+            }
+        }
+    }
+
+    /** Newton iteration **/
+    auto const dofs = 2 * states.size();
+    auto residual = residual_fn{settings, states.size()};
+    auto r = std::vector<double>(dofs);
+    auto trial_r = std::vector<double>(dofs);
+    auto step = std::vector<double>(dofs);
+    auto trial = states;
+
+    residual(states, r);
+    auto iteration = 0;
+    for (; iteration < max_iterations and max_norm(r) > tolerance * g; ++iteration) {
+        // stiffness = -jacobian: the rows of the fixed points become identities so they don't move
+        auto stiffness = sym::acceleration_jacobian(settings, states);
+        auto scale = 1.;
+        for (auto p = std::ptrdiff_t{0}; p < stiffness.size(); ++p) {
+            auto const is_fixed = states[p / 2].fixed;
+            for (auto q = p - bandwidth; q <= p + bandwidth; ++q) {
+                if (stiffness.in_band(p, q)) {
+                    stiffness(p, q) = is_fixed ? static_cast<double>(p == q) : -stiffness(p, q);
+                }
+            }
+            scale = std::max(scale, std::abs(stiffness(p, p)));
+        }
+
+        // Levenberg-Marquardt style damping when the plain Newton step does not reduce the residual
+        auto accepted = false;
+        for (auto μ = 0.; not accepted and μ <= 1e6 * scale; μ = std::max(10 * μ, 1e-8 * scale)) {
+            auto system = stiffness;
+            for (auto p = std::ptrdiff_t{0}; p < system.size(); ++p) {
+                if (not states[p / 2].fixed) {
+                    system(p, p) += μ;
+                }
+            }
+            if (not system.factorize()) {
+                continue;
+            }
+            step = r;
+            system.solve(step);
+            for (auto α = 1.; α > 1e-3; α /= 2) {
+                for (auto i = 0uz; i < states.size(); ++i) {
+                    for (auto c = 0uz; c < 2; ++c) {
+                        trial[i].x[c] = states[i].x[c] + α * step[2 * i + c] * ph::m;
+                    }
+                }
+                residual(trial, trial_r);
+                if (squared_norm(trial_r) < squared_norm(r)) {
+                    accepted = true;
+                    std::swap(states, trial);
+                    std::swap(r, trial_r);
+                    break;
+                }
+            }
+        }
+        if (not accepted) {
+            break;
+        }
+    }
+
+    if (auto const error = max_norm(r); error > tolerance * g) {
+        fmt::print(stderr, "Static equilibrium did not converge after {} iterations: residual {} m/s²\n", iteration, error);
+    }
+    return states;
+}
+
+}  // namespace sym
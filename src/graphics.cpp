@@ -19,9 +19,14 @@
 #include <implot.h>
 
 #include <mp-units/math.h>
+#include <numbers>
 
 #include <simulation.hpp>
+#include <equilibrium.hpp>
+#include <profiler.hpp>
 #include <expression.hpp>
+#include <evaluate.hpp>
+#include <shape_presets.hpp>
 
 // NOLINTBEGIN(concurrency-mt-unsafe)
 namespace gfx
@@ -44,12 +49,12 @@ auto setup_imgui(auto const & glsl_version, auto const & window, auto const & gl
 auto setup_SDL(int screen_width, int screen_height) -> SDL_stuff
 {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        fmt::print("SDL could not initialize! SDL_Error: {}\n", SDL_GetError());
+        fmt::print(stderr, "SDL could not initialize! SDL_Error: {}\n", SDL_GetError());
         std::exit(1);
     }
     auto _1 = nonstd::make_scope_exit(SDL_Quit);
     if (TTF_Init() == -1) {
-        fmt::print("SDL_ttf could not initialize! SDL_ttf error: {}\n", TTF_GetError());
+        fmt::print(stderr, "SDL_ttf could not initialize! SDL_ttf error: {}\n", TTF_GetError());
         std::exit(1);
     }
     auto _2 = nonstd::make_scope_exit(TTF_Quit);
@@ -75,7 +80,7 @@ auto setup_SDL(int screen_width, int screen_height) -> SDL_stuff
     };
 
     if (not window) {
-        fmt::print("Window could not be created! SDL_Error: {}\n", SDL_GetError());
+        fmt::print(stderr, "Window could not be created! SDL_Error: {}\n", SDL_GetError());
         std::exit(1);
     }
 
@@ -83,7 +88,7 @@ auto setup_SDL(int screen_width, int screen_height) -> SDL_stuff
             SDL_GL_CreateContext(window.get()), SDL_GL_DeleteContext
     };
     if (not gl_context) {
-        fmt::print("Could not create OpenGL context! Error: {}\n", SDL_GetError());
+        fmt::print(stderr, "Could not create OpenGL context! Error: {}\n", SDL_GetError());
         std::exit(1);
     }
     SDL_GL_MakeCurrent(window.get(), gl_context.get());
@@ -115,6 +120,15 @@ void forces_ui_fn::operator()() const noexcept
 #define REF(arg, unit) &settings->arg.numerical_value_ref_in(unit)  // NOLINT
 
     auto & enable = settings->enabled;
+    auto & substepped = settings->substepped;
+    auto const multirate = settings->substeps > 1;
+
+    {
+        constexpr auto min = 1;
+        constexpr auto max = 100;
+        ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x * 0.5f);
+        ImGui::SliderScalar("Substeps per time-step", ImGuiDataType_S32, &settings->substeps, &min, &max, "%d");
+    }
 
     gfx::tree_node("Elastic force", enable.elastic, [&] {
         constexpr auto min = 0.;
@@ -127,8 +141,11 @@ void forces_ui_fn::operator()() const noexcept
         if (ImGui::Button("Reset")) {
             settings->elastic_constant = initial_settings->elastic_constant;
         }
+        MAYBE_ENABLED(multirate, ImGui::Checkbox("Substepped##elastic", &substepped.elastic));
+    });
+    gfx::tree_node("Gravity", enable.gravity, [&] {
+        MAYBE_ENABLED(multirate, ImGui::Checkbox("Substepped##gravity", &substepped.gravity));
     });
-    gfx::tree_node("Gravity", enable.gravity, [] {});
     gfx::tree_node("External damping", enable.external_damping, [&] {
         constexpr auto min = 0.;
         constexpr auto max = 1.;
@@ -140,6 +157,7 @@ void forces_ui_fn::operator()() const noexcept
         if (ImGui::Button("Reset")) {
             settings->external_damping = initial_settings->external_damping;
         }
+        MAYBE_ENABLED(multirate, ImGui::Checkbox("Substepped##external_damping", &substepped.external_damping));
     });
     gfx::tree_node("Internal damping", enable.internal_damping, [&] {
         constexpr auto min = 0.;
@@ -152,6 +170,7 @@ void forces_ui_fn::operator()() const noexcept
         if (ImGui::Button("Reset")) {
             settings->internal_damping = initial_settings->internal_damping;
         }
+        MAYBE_ENABLED(multirate, ImGui::Checkbox("Substepped##internal_damping", &substepped.internal_damping));
     });
     gfx::tree_node("Flexural rigidity", enable.flexural_rigidity, [&] {
         constexpr auto E_min = 0.;
@@ -182,6 +201,7 @@ void forces_ui_fn::operator()() const noexcept
         if (ImGui::Button("Reset")) {
             settings->diameter = initial_settings->diameter;
         }
+        MAYBE_ENABLED(multirate, ImGui::Checkbox("Substepped##flexural_rigidity", &substepped.flexural_rigidity));
     });
 
     #undef REF
@@ -242,6 +262,7 @@ void data_ui_fn::operator()() const noexcept
         std::tuple{"Time", t},
         std::tuple{"Framerate", framerate},
         std::tuple{"Steps per frame", steps * mp_units::one},
+        std::tuple{"Time-step", settings->dt},
         // std::tuple{"Offset", screen_cfg->offset * mp_units::one},
         // std::tuple{"Scale", screen_cfg->scale * mp_units::one},
         std::tuple{"Length", total_len},
@@ -287,6 +308,72 @@ void data_ui_fn::operator()() const noexcept
         for_each(args, print_line);
         ImGui::EndTable();
     }
+
+    if constexpr (sym::allocations::enabled) {
+        if (ImGui::BeginTable("Allocations", 3, table_flags)) {
+            ImGui::TableSetupColumn("Allocations per frame");
+            ImGui::TableSetupColumn("Count");
+            ImGui::TableSetupColumn("Bytes");
+            ImGui::TableHeadersRow();
+            for (auto const s : sym::allocations::subsystems) {
+                auto const [count, bytes] = (*allocations)[std::to_underlying(s)];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", sym::allocations::name(s).data());  // NOLINT(*-vararg)
+                ImGui::TableNextColumn();
+                ImGui::Text("%10llu", static_cast<unsigned long long>(count));  // NOLINT(*-vararg)
+                ImGui::TableNextColumn();
+                ImGui::Text("%10llu", static_cast<unsigned long long>(bytes));  // NOLINT(*-vararg)
+            }
+            ImGui::EndTable();
+        }
+    }
+}
+
+void profiler_ui_fn::operator()() const noexcept
+{
+    constexpr auto table_flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg;
+    constexpr auto columns = static_cast<int>(sym::profiler::events.size()) + 4;
+    auto const point_steps = static_cast<double>(std::max(points * steps, std::size_t{1}));
+
+    if (ImGui::BeginTable("Counters", columns, table_flags)) {
+        ImGui::TableSetupColumn("Zone");
+        ImGui::TableSetupColumn("Calls");
+        ImGui::TableSetupColumn("Per");
+        for (auto const e : sym::profiler::events) {
+            ImGui::TableSetupColumn(sym::profiler::name(e).data());
+        }
+        ImGui::TableSetupColumn("IPC");
+        ImGui::TableHeadersRow();
+        for (auto const z : sym::profiler::zones) {
+            auto const r = sym::profiler::read(z);
+            if (r.calls == 0) {
+                continue;
+            }
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", sym::profiler::name(z).data());  // NOLINT(*-vararg)
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(r.calls));  // NOLINT(*-vararg)
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(sym::profiler::per_point(z) ? "point and step" : "call");
+            auto const scale = 1. / (sym::profiler::per_point(z) ? point_steps : static_cast<double>(r.calls));
+            for (auto const e : sym::profiler::events) {
+                auto const idx = std::to_underlying(e);
+                ImGui::TableNextColumn();
+                if (r.available[idx]) {
+                    ImGui::Text("%.3f", static_cast<double>(r.values[idx]) * scale);  // NOLINT(*-vararg)
+                } else {
+                    ImGui::Text("n/a");  // NOLINT(*-vararg)
+                }
+            }
+            auto const cycles = r.values[std::to_underlying(sym::profiler::event::cycles)];
+            auto const instructions = r.values[std::to_underlying(sym::profiler::event::instructions)];
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", cycles == 0 ? 0. : static_cast<double>(instructions) / static_cast<double>(cycles));  // NOLINT(*-vararg)
+        }
+        ImGui::EndTable();
+    }
 }
 
 void rope_editor_fn::operator()() noexcept
@@ -308,10 +395,25 @@ void rope_editor_fn::operator()() noexcept
     static auto x_expr = maybe_expression{brun::expr::expression{x, "t"}};
     static auto y_expr = maybe_expression{brun::expr::expression{y, "t"}};
     auto & equalize_distance = settings->equalize_distance;
-
+    auto & start_at_equilibrium = settings->start_at_equilibrium;
+
+    auto picked = false;
+    if (ImGui::BeginCombo("Preset", "Built-in shapes")) {
+        for (auto const & preset : sym::shape_presets) {
+            if (ImGui::Selectable(preset.name.data())) {
+                x_formula.fill('\0');
+                y_formula.fill('\0');
+                std::ranges::copy(preset.x_formula, x_formula.begin());
+                std::ranges::copy(preset.y_formula, y_formula.begin());
+                picked = true;
+            }
+        }
+        ImGui::EndCombo();
+    }
     ImGui::InputTextWithHint("= x(t)", x.data(), x_formula.data(), x_formula.size());
     ImGui::InputTextWithHint("= y(t)", y.data(), y_formula.data(), y_formula.size());
     ImGui::Checkbox("Equalize points distance", &equalize_distance);
+    ImGui::Checkbox("Start at static equilibrium", &start_at_equilibrium);
 
 
     auto eval = [](auto & arr) -> maybe_expression {
@@ -323,13 +425,13 @@ void rope_editor_fn::operator()() noexcept
     ImGui::SameLine();
     auto apply = ImGui::Button("Reset time and apply formulas");
 
-    if (preview or apply) {
+    if (preview or apply or picked) {
         update = true;
         x_expr = eval(x_formula);
         y_expr = eval(y_formula);
         if (not x_expr.has_value() or not y_expr.has_value()) {
             apply = false;
-            fmt::print("Bad formula!\n");
+            fmt::print(stderr, "Bad formula!\n");
             ImVec2 center = ImGui::GetMainViewport()->GetCenter();
             ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
             ImGui::OpenPopup("Bad formula");
@@ -339,6 +441,7 @@ void rope_editor_fn::operator()() noexcept
     if (apply) {
         settings->x_formula = x_formula | std::ranges::to<std::string>();
         settings->y_formula = y_formula | std::ranges::to<std::string>();
+        settings->shape_file.clear();
         sym::reset(*settings, *rope, *metadata, *t);
     }
 
@@ -355,11 +458,22 @@ void rope_editor_fn::operator()() noexcept
             auto fn = [x=(*x_expr)['t'],y=(*y_expr)['t']] (auto n) {
                 return math::vector<double, 2>{x(n), y(n)};
             };
-            equidistant_points = sym::equidistant_points_along_function(fn, 100);
             original = std::views::iota(0, 11)
                 | std::views::transform([](auto i) { return double(i) / 10; })
                 | std::views::transform(fn)
                 | std::ranges::to<std::vector>();
+            auto const length = std::ranges::fold_left(original | std::views::pairwise_transform([](auto a, auto b) {
+                return math::norm(b - a);
+            }), 0., std::plus{});
+            if (std::isfinite(length) and length > 0.) {
+                auto const bound = [] (brun::expr::dual<brun::expr::interval> const & t) {
+                    return std::array{brun::expr::evaluate(*x_expr, 't', t), brun::expr::evaluate(*y_expr, 't', t)};
+                };
+                auto const polyline = sym::adaptive_points_along_function(fn, bound, 1e-3 * length);
+                equidistant_points = sym::equidistant_points_along_polyline(polyline, 100);
+            } else {
+                equidistant_points = sym::equidistant_points_along_function(fn, 100);
+            }
             equalized = equidistant_points | std::views::stride(equidistant_points.size() / 10) | std::ranges::to<std::vector>();
         }
 
@@ -474,5 +588,82 @@ void arrows_ui::operator()() noexcept
     }
 }
 
+void modes_ui::compute() noexcept
+{
+    selected = -1;
+    modes.clear();
+    error.clear();
+    try {
+        auto const around = at_equilibrium
+                          ? sym::static_equilibrium(*settings, *rope)
+                          : std::vector<ph::state>(rope->begin(), rope->end());
+        modes = sym::natural_modes(*settings, around, count);
+        base = around | std::views::transform(&ph::state::x) | std::ranges::to<std::vector>();
+    } catch (std::exception const & e) {
+        error = e.what();
+    }
+}
+
+void modes_ui::operator()() noexcept
+{
+    constexpr auto min = 1;
+    constexpr auto max = 20;
+    constexpr auto table_flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg;
+    ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x * 0.5f);
+    ImGui::SliderScalar("Modes", ImGuiDataType_S32, &count, &min, &max, "%d");
+    ImGui::Checkbox("Around the static equilibrium", &at_equilibrium);
+    if (ImGui::Button("Compute")) {
+        compute();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Show the rope")) {
+        selected = -1;
+    }
+    if (not error.empty()) {
+        ImGui::TextUnformatted(error.c_str());
+    }
+    ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x * 0.5f);
+    ImGui::SliderFloat("Amplitude", &amplitude, 0.001f, 0.5f, "%.3f", ImGuiSliderFlags_Logarithmic);
+
+    if (modes.empty()) {
+        return;
+    }
+    ImGui::Text("Click a mode to animate it, at one period per second");  // NOLINT(*-vararg)
+    if (ImGui::BeginTable("Natural modes", 3, table_flags)) {
+        ImGui::TableSetupColumn("Mode");
+        ImGui::TableSetupColumn("Frequency");
+        ImGui::TableSetupColumn("Period");
+        ImGui::TableHeadersRow();
+        for (auto i = 0; i < std::ssize(modes); ++i) {
+            auto const f = modes[i].frequency.numerical_value_in(ph::Hz);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            if (ImGui::Selectable(fmt::format("{}", i + 1).c_str(), selected == i, ImGuiSelectableFlags_SpanAllColumns)) {
+                selected = selected == i ? -1 : i;
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.4g Hz", f);  // NOLINT(*-vararg)
+            ImGui::TableNextColumn();
+            if (f > 0.) {
+                ImGui::Text("%.4g s", 1. / f);  // NOLINT(*-vararg)
+            } else {
+                ImGui::Text("-");  // NOLINT(*-vararg)
+            }
+        }
+        ImGui::EndTable();
+    }
+}
+
+auto modes_ui::animated(double time) -> std::vector<ph::position> const &
+{
+    auto const & shape = modes[static_cast<std::size_t>(selected)].shape;
+    auto const scale = amplitude * std::sin(2 * std::numbers::pi * time) * settings->total_length;
+    frame.resize(base.size());
+    for (auto && [x, x0, d] : std::views::zip(frame, base, shape)) {
+        x = x0 + d * scale;
+    }
+    return frame;
+}
+
 }  // namespace gfx
 // NOLINTEND(concurrency-mt-unsafe)
@@ -0,0 +1,251 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : interval
+ * @created     : Wednesday Oct 21, 2026 14:40:07 CEST
+ * @description : interval arithmetic for the expressions
+ */
+
+#include <interval.hpp>
+#include <array>
+#include <numbers>
+#include <ranges>
+
+namespace brun::expr
+{
+
+namespace
+{
+constexpr auto infinity = std::numeric_limits<const_t>::infinity();
+constexpr auto two_pi = 2 * std::numbers::pi_v<const_t>;
+
+// the library functions are faithfully rounded, not correctly: the value of `expression::eval` may be
+// one ulp on either side, so the bounds computed by them are widened by two ulps
+auto library(const_t lo, const_t hi) -> interval
+{
+    if (std::isnan(lo) or std::isnan(hi)) {
+        return interval::entire();
+    }
+    for (auto i = 0; i < 2; ++i) {
+        lo = std::nextafter(lo, -infinity);
+        hi = std::nextafter(hi, infinity);
+    }
+    return {lo, hi};
+}
+
+auto library(std::array<const_t, 4> const & values) -> interval
+{
+    if (std::ranges::any_of(values, [](auto v) { return std::isnan(v); })) {
+        return interval::entire();
+    }
+    auto const [lo, hi] = std::ranges::minmax(values);
+    return library(lo, hi);
+}
+
+// the result of an operation, whose exact value is `value + error`: NaN if the error is unknown
+struct rounded
+{
+    const_t value;
+    const_t error;
+};
+
+auto sum(const_t a, const_t b) -> rounded  // TwoSum
+{
+    auto const s = a + b;
+    auto const b_virtual = s - a;
+    return {s, (a - (s - b_virtual)) + (b - b_virtual)};
+}
+
+// below this the error of a product or a quotient may underflow
+constexpr auto tiny = 0x1p-968;
+
+auto product(const_t a, const_t b) -> rounded
+{
+    auto const p = a * b;
+    if (a == 0. or b == 0.) {
+        return {p, 0.};
+    }
+    return {p, std::abs(p) < tiny ? std::numeric_limits<const_t>::quiet_NaN() : std::fma(a, b, -p)};
+}
+
+auto quotient(const_t a, const_t b) -> rounded
+{
+    auto const q = a / b;
+    if (a == 0.) {
+        return {q, 0.};
+    }
+    // the remainder is exact, and its ratio to the divisor has the sign of the error
+    return {q, std::abs(q) < tiny ? std::numeric_limits<const_t>::quiet_NaN() : std::fma(-q, b, a) / b};
+}
+
+// rounded towards -infinity and +infinity: exact results are kept, the others are moved by one ulp
+auto down(rounded const & r) { return r.error >= 0. ? r.value : std::nextafter(r.value, -infinity); }
+auto up(rounded const & r) { return r.error <= 0. ? r.value : std::nextafter(r.value, infinity); }
+
+auto bounds(rounded const & lo, rounded const & hi) -> interval
+{
+    if (std::isnan(lo.value) or std::isnan(hi.value)) {
+        return interval::entire();
+    }
+    return {down(lo), up(hi)};
+}
+
+auto bounds(std::array<rounded, 4> const & corners) -> interval
+{
+    if (std::ranges::any_of(corners, [](auto const & r) { return std::isnan(r.value); })) {
+        return interval::entire();
+    }
+    auto const lo = std::ranges::min(corners | std::views::transform([](auto const & r) { return down(r); }));
+    auto const hi = std::ranges::max(corners | std::views::transform([](auto const & r) { return up(r); }));
+    return {lo, hi};
+}
+
+// whether [lo, hi] contains `point + k * period` for some integer k, erring on the side of yes
+auto contains_periodic(interval const & a, const_t point, const_t period) -> bool
+{
+    auto const k = std::floor((a.hi - point) / period);
+    auto const nearest = point + k * period;
+    auto const slack = 4 * std::numeric_limits<const_t>::epsilon() * std::max({1., std::abs(a.lo), std::abs(a.hi)});
+    return nearest >= a.lo - slack;
+}
+
+// a monotonic function, clamping the operand to its domain [min, max]
+template <typename Function>
+auto monotonic(interval const & a, Function f, bool increasing, const_t min = -infinity, const_t max = infinity)
+    -> interval
+{
+    if (a.hi < min or a.lo > max) {
+        return interval::entire();
+    }
+    auto const lo = f(std::max(a.lo, min));
+    auto const hi = f(std::min(a.hi, max));
+    return increasing ? library(lo, hi) : library(hi, lo);
+}
+
+auto is_integer(interval const & a) noexcept
+{
+    return a.lo == a.hi and std::trunc(a.lo) == a.lo and std::abs(a.lo) < 0x1p53;
+}
+}  // namespace
+
+auto operator+(interval const & a, interval const & b) -> interval { return bounds(sum(a.lo, b.lo), sum(a.hi, b.hi)); }
+auto operator-(interval const & a, interval const & b) -> interval { return bounds(sum(a.lo, -b.hi), sum(a.hi, -b.lo)); }
+
+auto operator*(interval const & a, interval const & b) -> interval
+{
+    return bounds({product(a.lo, b.lo), product(a.lo, b.hi), product(a.hi, b.lo), product(a.hi, b.hi)});
+}
+
+auto operator/(interval const & a, interval const & b) -> interval
+{
+    if (b.contains(0.)) {
+        return interval::entire();
+    }
+    return bounds({quotient(a.lo, b.lo), quotient(a.lo, b.hi), quotient(a.hi, b.lo), quotient(a.hi, b.hi)});
+}
+
+auto sin(interval const & a) -> interval
+{
+    if (not a.is_finite() or a.width() >= two_pi) {
+        return {-1., 1.};
+    }
+    auto [lo, hi] = std::minmax({std::sin(a.lo), std::sin(a.hi)});
+    hi = contains_periodic(a, std::numbers::pi / 2, two_pi) ? 1. : hi;
+    lo = contains_periodic(a, -std::numbers::pi / 2, two_pi) ? -1. : lo;
+    auto const result = library(lo, hi);
+    return {std::max(result.lo, -1.), std::min(result.hi, 1.)};
+}
+
+auto cos(interval const & a) -> interval
+{
+    if (not a.is_finite() or a.width() >= two_pi) {
+        return {-1., 1.};
+    }
+    auto [lo, hi] = std::minmax({std::cos(a.lo), std::cos(a.hi)});
+    hi = contains_periodic(a, 0., two_pi) ? 1. : hi;
+    lo = contains_periodic(a, std::numbers::pi, two_pi) ? -1. : lo;
+    auto const result = library(lo, hi);
+    return {std::max(result.lo, -1.), std::min(result.hi, 1.)};
+}
+
+auto tan(interval const & a) -> interval
+{
+    if (not a.is_finite() or a.width() >= std::numbers::pi or contains_periodic(a, std::numbers::pi / 2, std::numbers::pi)) {
+        return interval::entire();
+    }
+    return library(std::tan(a.lo), std::tan(a.hi));
+}
+
+auto asin(interval const & a) -> interval { return monotonic(a, [](auto x) { return std::asin(x); }, true, -1., 1.); }
+auto acos(interval const & a) -> interval { return monotonic(a, [](auto x) { return std::acos(x); }, false, -1., 1.); }
+auto atan(interval const & a) -> interval { return monotonic(a, [](auto x) { return std::atan(x); }, true); }
+auto cbrt(interval const & a) -> interval { return monotonic(a, [](auto x) { return std::cbrt(x); }, true); }
+
+auto exp(interval const & a) -> interval
+{
+    auto const result = monotonic(a, [](auto x) { return std::exp(x); }, true);
+    return {std::max(result.lo, 0.), result.hi};
+}
+
+auto log(interval const & a) -> interval
+{
+    if (a.hi <= 0.) {
+        return interval::entire();
+    }
+    return library(a.lo <= 0. ? -infinity : std::log(a.lo), std::log(a.hi));
+}
+
+auto sqrt(interval const & a) -> interval
+{
+    auto const result = monotonic(a, [](auto x) { return std::sqrt(x); }, true, 0.);
+    return {std::max(result.lo, 0.), result.hi};
+}
+
+auto abs(interval const & a) -> interval
+{
+    if (a.lo >= 0.) {
+        return a;
+    }
+    if (a.hi <= 0.) {
+        return -a;
+    }
+    return {0., std::max(-a.lo, a.hi)};
+}
+
+auto pow(interval const & a, interval const & b) -> interval
+{
+    if (is_integer(b)) {
+        auto const n = b.lo;
+        if (n == 0.) {
+            return {1.};
+        }
+        auto const base = std::fmod(n, 2.) == 0. ? abs(a) : a;  // monotonic in the base for odd n
+        if (n < 0. and base.contains(0.)) {
+            return interval::entire();
+        }
+        auto const [lo, hi] = std::minmax({std::pow(base.lo, n), std::pow(base.hi, n)});
+        return library(lo, hi);
+    }
+    if (a.lo < 0.) {
+        return interval::entire();  // not defined for the negative bases
+    }
+    // monotonic in each operand, so the extremes are in the corners
+    return library({std::pow(a.lo, b.lo), std::pow(a.lo, b.hi), std::pow(a.hi, b.lo), std::pow(a.hi, b.hi)});
+}
+
+auto modulus(interval const & a, interval const & b) -> interval
+{
+    constexpr auto max_long = static_cast<const_t>(std::numeric_limits<long>::max());
+    auto const divisor = abs(b);
+    if (not a.is_finite() or not b.is_finite() or std::max(std::abs(a.lo), std::abs(a.hi)) >= max_long
+        or divisor.hi >= max_long or divisor.lo < 1.) {
+        return interval::entire();  // a truncated divisor may be zero
+    }
+    if (a.lo == a.hi and b.lo == b.hi) {
+        return {static_cast<const_t>(static_cast<long>(a.lo) % static_cast<long>(b.lo))};
+    }
+    // the remainder is smaller than the divisor and than the dividend, and has the sign of the dividend
+    auto const bound = std::min(std::trunc(divisor.hi) - 1, std::trunc(std::max(-a.lo, a.hi)));
+    return {a.lo < 0. ? -bound : 0., a.hi > 0. ? bound : 0.};
+}
+
+}  // namespace brun::expr
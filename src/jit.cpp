@@ -0,0 +1,514 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : jit
+ * @created     : Tuesday Oct 20, 2026 10:40:19 CEST
+ * @description :
+ */
+
+#include <jit.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace brun::expr
+{
+
+void compiled_expression::unmap::operator()([[maybe_unused]] void * memory) const noexcept
+{
+#if defined(__x86_64__)
+    ::munmap(memory, size);
+#endif
+}
+
+void compiled_expression::operator()(std::span<const_t const> values, std::span<const_t> out) const
+{
+    auto i = 0uz;
+    if (_batch != nullptr) {
+        auto const groups = values.size() / 4;
+        _batch(values.data(), out.data(), groups);
+        i = groups * 4;
+    }
+    for (; i < values.size(); ++i) {
+        out[i] = (*this)(values[i]);
+    }
+}
+
+#if defined(__x86_64__)
+namespace
+{
+// the functions called by the native code: the same the interpreter calls
+auto call_sin(const_t a) -> const_t { return std::sin(a); }
+auto call_cos(const_t a) -> const_t { return std::cos(a); }
+auto call_tan(const_t a) -> const_t { return std::tan(a); }
+auto call_asin(const_t a) -> const_t { return std::asin(a); }
+auto call_acos(const_t a) -> const_t { return std::acos(a); }
+auto call_atan(const_t a) -> const_t { return std::atan(a); }
+auto call_exp(const_t a) -> const_t { return std::exp(a); }
+auto call_ln(const_t a) -> const_t { return std::log(a); }
+auto call_cbrt(const_t a) -> const_t { return std::cbrt(a); }
+auto call_pow(const_t a, const_t b) -> const_t { return std::pow(a, b); }
+auto call_modulus(const_t a, const_t b) -> const_t
+{
+    return static_cast<const_t>(static_cast<long>(a) % static_cast<long>(b));
+}
+
+auto unary_function(char op) -> const_t (*)(const_t)
+{
+    switch (op) {
+        case 's': return call_sin;
+        case 'c': return call_cos;
+        case 't': return call_tan;
+        case 'S': return call_asin;
+        case 'C': return call_acos;
+        case 'T': return call_atan;
+        case 'e': return call_exp;
+        case 'l': return call_ln;
+        case 'V': return call_cbrt;
+        default: return nullptr;
+    }
+}
+
+// thrown when the expression cannot be compiled
+struct unsupported {};
+
+// registers 0 to 13 hold the values being computed
+constexpr auto max_register = 13;
+
+/*
+ * Stack frame, below the saved rbp, rbx, r12, r13 and r14:
+ * the parameter, two call arguments and a spill slot for each register, 32 bytes each
+ */
+constexpr auto param_slot = -64;
+constexpr auto first_argument = -96;
+constexpr auto second_argument = -128;
+constexpr auto spill_slot(int reg) { return -160 - 32 * reg; }
+constexpr auto frame_size = 160 + 32 * max_register - 32;  // below the saved registers
+
+// general purpose registers
+constexpr auto rbx = 3;
+constexpr auto r14 = 14;
+
+struct operand
+{
+    enum class kind : std::uint8_t { xmm, frame, pool, base } type;
+    std::int32_t value;  // register, displacement from rbp, index in the pool or base register
+};
+
+constexpr auto xmm(int reg) { return operand{operand::kind::xmm, reg}; }
+constexpr auto frame(std::int32_t displacement) { return operand{operand::kind::frame, displacement}; }
+constexpr auto base(int reg) { return operand{operand::kind::base, reg}; }
+
+/**
+ * Emits the code and the constants; every constant is repeated four times, so it can be read as
+ * a scalar or as a whole vector. The first two are the masks of `abs` and of the negation.
+ */
+class assembler
+{
+public:
+    std::vector<std::uint8_t> code;
+
+    assembler()
+    {
+        constant(std::bit_cast<const_t>(~(std::uint64_t{1} << 63U)));
+        constant(std::bit_cast<const_t>(std::uint64_t{1} << 63U));
+    }
+
+    static constexpr auto abs_mask = operand{operand::kind::pool, 0};
+    static constexpr auto sign_mask = operand{operand::kind::pool, 1};
+
+    auto constant(const_t value) -> operand
+    {
+        auto const bits = std::bit_cast<std::uint64_t>(value);
+        auto const it = std::ranges::find(_pool, bits);
+        auto const index = it - _pool.begin();
+        if (it == _pool.end()) {
+            _pool.push_back(bits);
+        }
+        return {operand::kind::pool, static_cast<std::int32_t>(index)};
+    }
+
+    void emit(std::initializer_list<std::uint8_t> bytes) { code.insert(code.end(), bytes); }
+
+    template <typename T>
+    void emit_le(T value)
+    {
+        for (auto i = 0U; i < sizeof(T); ++i) {
+            code.push_back(static_cast<std::uint8_t>(static_cast<std::uint64_t>(value) >> (8 * i)));
+        }
+    }
+
+    // legacy SSE instruction: prefix [REX] 0F opcode ModRM
+    void sse(std::uint8_t prefix, std::uint8_t opcode, int reg, operand rm)
+    {
+        code.push_back(prefix);
+        auto const rex = 0x40U | ((static_cast<unsigned>(reg) >> 3U) << 2U) | extension(rm);
+        if (rex != 0x40U) {
+            code.push_back(static_cast<std::uint8_t>(rex));
+        }
+        emit({0x0F, opcode});
+        modrm(reg, rm);
+    }
+
+    // 256 bits VEX instruction; pp: 1 for 66, map: 1 for 0F, 2 for 0F38
+    void vex(std::uint8_t pp, std::uint8_t map, std::uint8_t opcode, int reg, int vvvv, operand rm)
+    {
+        auto const r = (~static_cast<unsigned>(reg) >> 3U) & 1U;
+        auto const b = ~extension(rm) & 1U;
+        code.push_back(0xC4);
+        code.push_back(static_cast<std::uint8_t>(r << 7U | 1U << 6U | b << 5U | map));
+        code.push_back(static_cast<std::uint8_t>((~static_cast<unsigned>(vvvv) & 0xFU) << 3U | 1U << 2U | pp));
+        code.push_back(opcode);
+        modrm(reg, rm);
+    }
+
+    void call(void const * function)
+    {
+        emit({0x48, 0xB8});  // mov rax, imm64
+        emit_le(std::bit_cast<std::uintptr_t>(function));
+        emit({0xFF, 0xD0});  // call rax
+    }
+
+    void prologue()
+    {
+        emit({0x55, 0x48, 0x89, 0xE5});  // push rbp; mov rbp, rsp
+        emit({0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56});  // push rbx, r12, r13, r14
+        emit({0x48, 0x81, 0xEC});  // sub rsp, imm32
+        emit_le(std::uint32_t{frame_size});
+    }
+
+    void epilogue()
+    {
+        emit({0x48, 0x8D, 0x65, 0xE0});  // lea rsp, [rbp - 32]
+        emit({0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5B, 0x5D, 0xC3});  // pop r14, r13, r12, rbx, rbp; ret
+    }
+
+    // appends the constants and resolves the references to them
+    void finish()
+    {
+        code.resize((code.size() + 31) / 32 * 32, 0xCC);
+        auto const pool = code.size();
+        for (auto const bits : _pool) {
+            for (auto lane = 0; lane < 4; ++lane) {
+                emit_le(bits);
+            }
+        }
+        for (auto const & [position, index] : _fixups) {
+            auto const target = static_cast<std::ptrdiff_t>(pool + 32 * index);
+            auto const displacement = static_cast<std::int32_t>(target - static_cast<std::ptrdiff_t>(position + 4));
+            std::memcpy(code.data() + position, &displacement, sizeof(displacement));
+        }
+    }
+
+private:
+    std::vector<std::uint64_t> _pool;
+    std::vector<std::pair<std::size_t, std::size_t>> _fixups;  // displacement position, constant
+
+    static auto extension(operand rm) noexcept -> unsigned
+    {
+        auto const is_register = rm.type == operand::kind::xmm or rm.type == operand::kind::base;
+        return is_register ? (static_cast<unsigned>(rm.value) >> 3U) & 1U : 0U;
+    }
+
+    void modrm(int reg, operand rm)
+    {
+        auto const r = (static_cast<unsigned>(reg) & 7U) << 3U;
+        switch (rm.type) {
+        case operand::kind::xmm:
+            code.push_back(static_cast<std::uint8_t>(0xC0U | r | (static_cast<unsigned>(rm.value) & 7U)));
+            break;
+        case operand::kind::frame:  // [rbp + disp32]
+            code.push_back(static_cast<std::uint8_t>(0x80U | r | 5U));
+            emit_le(static_cast<std::uint32_t>(rm.value));
+            break;
+        case operand::kind::pool:  // [rip + disp32]
+            code.push_back(static_cast<std::uint8_t>(r | 5U));
+            _fixups.emplace_back(code.size(), static_cast<std::size_t>(rm.value));
+            emit_le(std::uint32_t{0});
+            break;
+        case operand::kind::base:  // [reg], not rsp, rbp, r12 or r13
+            code.push_back(static_cast<std::uint8_t>(r | (static_cast<unsigned>(rm.value) & 7U)));
+            break;
+        }
+    }
+};
+
+/**
+ * Emits the code of a tree leaving its value in a register: a binary node computes one operand in
+ * its register and the other in the next one, the operand needing more registers first, so that
+ * the nestings on the right (as in Horner's form) use no more registers than those on the left.
+ * With `wide` the registers are ymm and hold four values.
+ */
+class generator
+{
+    assembler & _asm;
+    bool _wide;
+    param_t _param;
+
+public:
+    generator(assembler & a, bool wide, param_t param) : _asm{a}, _wide{wide}, _param{param} {}
+
+    void load(int reg, operand from)
+    {
+        if (not _wide) {
+            _asm.sse(0xF2, 0x10, reg, from);  // movsd
+        } else if (from.type == operand::kind::pool) {
+            _asm.vex(1, 2, 0x19, reg, 0, from);  // vbroadcastsd
+        } else {
+            _asm.vex(1, 1, 0x10, reg, 0, from);  // vmovupd
+        }
+    }
+
+    void store(operand to, int reg)
+    {
+        if (_wide) {
+            _asm.vex(1, 1, 0x11, reg, 0, to);  // vmovupd
+        } else {
+            _asm.sse(0xF2, 0x11, reg, to);  // movsd
+        }
+    }
+
+    // reg = reg op rm, with op one of addpd, mulpd, subpd, divpd, andpd, xorpd
+    void arithmetic(std::uint8_t opcode, int reg, operand rm)
+    {
+        auto const logic = opcode == 0x54 or opcode == 0x57;
+        if (_wide) {
+            _asm.vex(1, 1, opcode, reg, reg, rm);
+        } else {
+            _asm.sse(logic ? 0x66 : 0xF2, opcode, reg, rm);
+        }
+    }
+
+    void generate(node const & n, int reg)  // NOLINT(misc-no-recursion)
+    {
+        if (reg > max_register) {
+            throw unsupported{};
+        }
+        if (auto const * value = std::get_if<const_t>(&n.content)) {
+            load(reg, _asm.constant(*value));
+        } else if (auto const * p = std::get_if<param_t>(&n.content)) {
+            if (*p != _param) {
+                throw unsupported{};
+            }
+            load(reg, frame(param_slot));
+        } else if (std::holds_alternative<unary_f>(n.content) and n.left) {
+            generate(*n.left, reg);
+            switch (n.op) {
+            case 'v':
+                _wide ? _asm.vex(1, 1, 0x51, reg, 0, xmm(reg)) : _asm.sse(0xF2, 0x51, reg, xmm(reg));  // sqrt
+                break;
+            case '|':
+                arithmetic(0x54, reg, assembler::abs_mask);
+                break;
+            case 'n':
+                arithmetic(0x57, reg, assembler::sign_mask);
+                break;
+            default:
+                if (auto const function = unary_function(n.op); function != nullptr) {
+                    call(std::bit_cast<void const *>(function), reg, reg);
+                } else {
+                    throw unsupported{};
+                }
+            }
+        } else if (std::holds_alternative<binary_f>(n.content) and n.left and n.right) {
+            auto const opcodes = std::array<std::pair<char, std::uint8_t>, 4>{{
+                {'+', 0x58}, {'*', 0x59}, {'-', 0x5C}, {'/', 0x5E}
+            }};
+            auto const it = std::ranges::find(opcodes, n.op, &std::pair<char, std::uint8_t>::first);
+            auto const arithmetic_op = it != opcodes.end();
+            if (not arithmetic_op and n.op != '^' and n.op != '%') {
+                throw unsupported{};
+            }
+            auto const right_first = registers(*n.right, arithmetic_op) > registers(*n.left);
+            if (right_first) {
+                generate(*n.right, reg);
+                generate(*n.left, reg + 1);
+            } else {
+                generate(*n.left, reg);
+            }
+            auto const left = right_first ? reg + 1 : reg;
+            auto const right = right_first ? reg : reg + 1;
+            if (arithmetic_op) {
+                arithmetic(it->second, left, right_first ? xmm(right) : operand_of(*n.right, right));
+            } else {
+                if (not right_first) {
+                    generate(*n.right, right);
+                }
+                auto const function = n.op == '^' ? call_pow : call_modulus;
+                call(std::bit_cast<void const *>(function), reg, left, right);
+            }
+            if (arithmetic_op and right_first) {
+                _wide ? _asm.vex(1, 1, 0x28, reg, 0, xmm(left)) : _asm.sse(0x66, 0x28, reg, xmm(left));  // movapd
+            }
+        } else {
+            throw unsupported{};
+        }
+    }
+
+private:
+    // a constant or the parameter are read from memory, anything else from the next register
+    auto operand_of(node const & n, int reg) -> operand  // NOLINT(misc-no-recursion)
+    {
+        if (auto const * value = std::get_if<const_t>(&n.content)) {
+            return _asm.constant(*value);
+        }
+        if (auto const * p = std::get_if<param_t>(&n.content); p != nullptr and *p == _param) {
+            return frame(param_slot);
+        }
+        generate(n, reg);
+        return xmm(reg);
+    }
+
+    // registers needed by a tree; a leaf on the right of an arithmetic operator is read from memory
+    static auto registers(node const & n, bool from_memory = false) -> int  // NOLINT(misc-no-recursion)
+    {
+        if (not n.left) {
+            return from_memory ? 0 : 1;
+        }
+        if (not n.right) {
+            return registers(*n.left);
+        }
+        auto const left = registers(*n.left);
+        auto const right = registers(*n.right, n.op != '^' and n.op != '%');
+        return left == right ? left + 1 : std::max(left, right);
+    }
+
+    // reg = function(first[, second]) saving the registers below reg, lane by lane if wide
+    void call(void const * function, int reg, int first, int second = -1)
+    {
+        for (auto i = 0; i < reg; ++i) {
+            store(frame(spill_slot(i)), i);
+        }
+        auto const binary = second >= 0;
+        if (_wide) {
+            store(frame(first_argument), first);
+            if (binary) {
+                store(frame(second_argument), second);
+            }
+            _asm.emit({0xC5, 0xF8, 0x77});  // vzeroupper
+            for (auto lane = 0; lane < 4; ++lane) {
+                _asm.sse(0xF2, 0x10, 0, frame(first_argument + 8 * lane));
+                if (binary) {
+                    _asm.sse(0xF2, 0x10, 1, frame(second_argument + 8 * lane));
+                }
+                _asm.call(function);
+                _asm.sse(0xF2, 0x11, 0, frame(first_argument + 8 * lane));
+            }
+            load(reg, frame(first_argument));
+        } else {
+            // through xmm15, which is never allocated, as the arguments may be swapped
+            if (binary) {
+                _asm.sse(0xF2, 0x10, 15, xmm(second));
+            }
+            if (first != 0) {
+                _asm.sse(0xF2, 0x10, 0, xmm(first));
+            }
+            if (binary) {
+                _asm.sse(0xF2, 0x10, 1, xmm(15));
+            }
+            _asm.call(function);
+            if (reg != 0) {
+                _asm.sse(0xF2, 0x10, reg, xmm(0));
+            }
+        }
+        for (auto i = 0; i < reg; ++i) {
+            load(i, frame(spill_slot(i)));
+        }
+    }
+};
+
+// double f(double)
+void emit_scalar(assembler & a, node const & root, param_t param)
+{
+    a.prologue();
+    a.sse(0xF2, 0x11, 0, frame(param_slot));  // movsd [param], xmm0
+    generator{a, false, param}.generate(root, 0);
+    a.epilogue();
+}
+
+// void f(double const * in, double * out, size_t groups_of_four)
+void emit_batch(assembler & a, node const & root, param_t param)
+{
+    auto gen = generator{a, true, param};
+    a.prologue();
+    a.emit({0x48, 0x89, 0xFB});  // mov rbx, rdi
+    a.emit({0x49, 0x89, 0xF6});  // mov r14, rsi
+    a.emit({0x49, 0x89, 0xD4});  // mov r12, rdx
+    a.emit({0x4D, 0x85, 0xE4});  // test r12, r12
+    a.emit({0x0F, 0x84});  // jz end
+    auto const skip = a.code.size();
+    a.emit_le(std::uint32_t{0});
+
+    auto const loop = a.code.size();
+    gen.load(0, base(rbx));
+    gen.store(frame(param_slot), 0);
+    gen.generate(root, 0);
+    gen.store(base(r14), 0);
+    a.emit({0x48, 0x83, 0xC3, 0x20});  // add rbx, 32
+    a.emit({0x49, 0x83, 0xC6, 0x20});  // add r14, 32
+    a.emit({0x49, 0xFF, 0xCC});  // dec r12
+    a.emit({0x0F, 0x85});  // jnz loop
+    a.emit_le(static_cast<std::uint32_t>(static_cast<std::int32_t>(loop - (a.code.size() + 4))));
+
+    auto const end = static_cast<std::int32_t>(a.code.size() - (skip + 4));
+    std::memcpy(a.code.data() + skip, &end, sizeof(end));
+    a.emit({0xC5, 0xF8, 0x77});  // vzeroupper
+    a.epilogue();
+}
+}  // namespace
+#endif
+
+compiled_expression::compiled_expression(expression expr, param_t param)
+    : _expression{std::move(expr)}, _param{param}, _code{nullptr, unmap{0}}
+{
+#if defined(__x86_64__)
+    auto const * root = _expression.root();
+    if (root == nullptr) {
+        return;
+    }
+    auto a = assembler{};
+    auto batch_offset = 0uz;
+    auto const vectorize = __builtin_cpu_supports("avx2") != 0;
+    try {
+        emit_scalar(a, *root, param);
+        if (vectorize) {
+            a.code.resize((a.code.size() + 15) / 16 * 16, 0xCC);
+            batch_offset = a.code.size();
+            emit_batch(a, *root, param);
+        }
+    } catch (unsupported const &) {
+        return;
+    }
+    a.finish();
+
+    auto const page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    auto const size = (a.code.size() + page - 1) / page * page;
+    auto * memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return;
+    }
+    std::memcpy(memory, a.code.data(), a.code.size());
+    if (::mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        ::munmap(memory, size);
+        return;
+    }
+    _code = std::unique_ptr<void, unmap>{memory, unmap{size}};
+    auto * const bytes = static_cast<std::uint8_t *>(memory);
+    _scalar = std::bit_cast<scalar_fn>(static_cast<void *>(bytes));
+    if (vectorize) {
+        _batch = std::bit_cast<batch_fn>(static_cast<void *>(bytes + batch_offset));
+    }
+#endif
+}
+
+}  // namespace brun::expr
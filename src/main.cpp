@@ -20,10 +20,23 @@ struct SDL_Event {};
 #include <math.hpp>
 #include <mp-units/math.h>
 #include <thread>
+#include <csignal>
 #include <expected>
+#include <ranges>
 #include <structopt/app.hpp>
 
 #include "simulation.hpp"
+#include "scheduler.hpp"
+#include "buffer.hpp"
+#include "allocations.hpp"
+#include "profiler.hpp"
+#include "publisher.hpp"
+#include "shape_cache.hpp"
+#include "stream.hpp"
+#include "trajectory.hpp"
+#include "parareal.hpp"
+#include "calibration.hpp"
+#include "modal.hpp"
 #include <mp-units/systems/si/chrono.h>
 
 #include <expression.hpp>
@@ -39,10 +52,12 @@ auto rope_editor_ui(
     return gfx::rope_editor_fn{settings, rope, metadata, time};
 }
 
-auto data_ui(sym::settings const & settings, gfx::screen_config const & sc, auto const & rope, ph::time t, int steps)
-    -> gfx::data_ui_fn
+auto data_ui(
+    sym::settings const & settings, gfx::screen_config const & sc, auto const & rope, ph::time t, int steps,
+    sym::allocations::snapshot_t const & allocations
+) -> gfx::data_ui_fn
 {
-    return gfx::data_ui_fn{settings, sc, rope, t, steps};
+    return gfx::data_ui_fn{settings, sc, rope, t, steps, allocations};
 }
 struct options
 {
@@ -60,12 +75,38 @@ struct options
     std::optional<bool> pause = false;
     std::optional<std::string> x_formula = "t";
     std::optional<std::string> y_formula = "0";
+    std::optional<std::string> shape;
+    std::optional<std::string> shape_cache;
+    std::optional<bool> equilibrium = false;
+    std::optional<bool> auto_dt = false;
+    std::optional<int> substeps = 1;
+    std::optional<int> threads = 0;
+    std::optional<bool> pin_threads = false;
+    std::optional<bool> huge_pages = false;
+    std::optional<bool> check_allocations = false;
+    std::optional<bool> profile = false;
+    std::optional<std::string> shm;
+    std::optional<std::string> stream;
+    std::optional<std::string> stream_format = "ndjson";
+    std::optional<std::string> stream_fields = "position";
+    std::optional<int> stream_every = 1;
+    std::optional<std::string> record;
+    std::optional<double> record_error = 1e-6;
+    std::optional<int> parareal;
+    std::optional<double> parareal_dt = 0.;
+    std::optional<double> parareal_tolerance = 1e-6;
+    std::optional<std::string> calibrate;
+    std::optional<std::string> calibrate_parameters = "k,E,b,c";
+    std::optional<int> calibrate_samples = 100;
+    std::optional<int> modes;
 };
-STRUCTOPT(options, n, k, E, b, c, total_length, diameter, linear_density, dt, fps, duration, pause, x_formula, y_formula);
+STRUCTOPT(options, n, k, E, b, c, total_length, diameter, linear_density, dt, fps, duration, pause, x_formula, y_formula, shape, shape_cache, equilibrium, auto_dt, substeps, threads, pin_threads, huge_pages, check_allocations, profile, shm, stream, stream_format, stream_fields, stream_every, record, record_error, parareal, parareal_dt, parareal_tolerance, calibrate, calibrate_parameters, calibrate_samples, modes);
 
 int main(int argc, char * argv[]) try  // NOLINT
 {
     auto options = structopt::app("ropes").parse<::options>(argc, argv);
+    sym::scheduler::configure(static_cast<std::size_t>(std::max(*options.threads, 0)), *options.pin_threads);
+    sym::memory::use_huge_pages = *options.huge_pages;
 
     auto const initial_settings = sym::settings{
         options.n.value(),
@@ -81,12 +122,30 @@ int main(int argc, char * argv[]) try  // NOLINT
         options.duration.value() * ph::s,
         *options.x_formula,
         *options.y_formula,
+        true,
+        *options.equilibrium,
     };
     auto settings = initial_settings;
+    settings.substeps = std::max(*options.substeps, 1);
+    if (*options.auto_dt) {
+        settings.dt = sym::stable_timestep(settings);
+    }
 
     constexpr auto get_metadata = true;
 
-    dump_settings(settings);
+    // the stream may own stdout
+    auto const quiet = options.stream == "-";
+    if (not quiet) {
+        dump_settings(settings);
+    }
+
+    if (*options.check_allocations and not sym::allocations::enabled) {
+        fmt::print(stderr, "--check-allocations needs a build configured with -DROPES_COUNT_ALLOCATIONS=ON\n");
+        return 1;
+    }
+    if (*options.profile and not sym::profiler::enable()) {
+        fmt::print(stderr, "Cannot open the hardware counters: check /proc/sys/kernel/perf_event_paranoid\n");
+    }
 
 #ifndef NO_GRAPHICS
     constexpr auto screen_width = 800;
@@ -103,14 +162,191 @@ int main(int argc, char * argv[]) try  // NOLINT
     };
 #endif
 
-    auto x_expr = brun::expr::parse_expression(settings.x_formula, "t");
-    auto y_expr = brun::expr::parse_expression(settings.y_formula, "t");
-    auto fn = [x=x_expr.value()['t'], y=y_expr.value()['t']](auto t) { return ph::vector<>{x(t), -y(t)}; };
-    auto rope = sym::construct_rope(settings, fn);
-    auto metadata = std::vector<ph::metadata>{};
+    settings.shape_file = options.shape.value_or("");
+    if (options.shape_cache) {
+        sym::shape_cache::global().set_directory(*options.shape_cache);
+    }
+    // swapped with the results of the steps, so on the same memory
+    auto rope = sym::memory::vector<ph::state>{};
+    try {
+        auto const initial = sym::initial_rope(settings);
+        rope.assign(initial.begin(), initial.end());
+    } catch (std::exception const & e) {  // a bad formula or shape file
+        fmt::print(stderr, "{}\n", e.what());
+        return 1;
+    }
+    auto metadata = sym::memory::vector<ph::metadata>{};
+
+    // the constants fitted to a recording replace the ones of the CLI
+    if (options.calibrate) {
+        auto const parameters = sym::parse_calibrated_parameters(*options.calibrate_parameters);
+        if (not parameters) {
+            fmt::print(stderr, "{}\n", parameters.error());
+            return 1;
+        }
+        try {
+            auto reference = sym::trajectory_reader{*options.calibrate};
+            auto const result = sym::calibrate(settings, reference, {
+                .parameters = *parameters,
+                .samples = *options.calibrate_samples,
+            });
+            settings.elastic_constant = result.settings.elastic_constant;
+            settings.young_modulus = result.settings.young_modulus;
+            settings.external_damping = result.settings.external_damping;
+            settings.internal_damping = result.settings.internal_damping;
+            if (not quiet) {
+                fmt::print("calibration: {} simulations ({} aborted), RMS error {} ({})\n", result.evaluations,
+                    result.aborted, result.loss, result.converged ? "converged" : "not converged");
+                fmt::print("k = {} N/m, E = {} GPa, b = {} N s/m, c = {} N s/m\n",
+                    settings.elastic_constant.numerical_value_in(ph::N / ph::m),
+                    settings.young_modulus.numerical_value_in(ph::GPa),
+                    settings.external_damping.numerical_value_in(ph::N * ph::s / ph::m),
+                    settings.internal_damping.numerical_value_in(ph::N * ph::s / ph::m));
+            }
+        } catch (std::exception const & e) {  // a bad recording
+            fmt::print(stderr, "{}\n", e.what());
+            return 1;
+        }
+#ifdef NO_GRAPHICS
+        return 0;
+#endif
+    }
+
+    auto const stream_format = sym::parse_stream_format(*options.stream_format);
+    auto const stream_fields = sym::parse_stream_fields(*options.stream_fields);
+    if (options.stream and (not stream_format or not stream_fields)) {
+        fmt::print(stderr, "{}\n", stream_format ? stream_fields.error() : stream_format.error());
+        return 1;
+    }
+    auto emitter = std::unique_ptr<sym::stream_emitter>{};
+    auto publisher = std::unique_ptr<sym::shm_publisher>{};
+    try {
+        if (options.stream) {
+            // a reader closing the stream must fail the write, not kill the process
+            std::signal(SIGPIPE, SIG_IGN);
+            emitter = std::make_unique<sym::stream_emitter>(
+                *options.stream,
+                sym::stream_emitter::options{*stream_format, *stream_fields, *options.stream_every}
+            );
+        }
+        // frames published for external tools, sized on the initial rope
+        if (options.shm) {
+            publisher = std::make_unique<sym::shm_publisher>(*options.shm, rope.size());
+        }
+    } catch (std::system_error const & e) {  // a bad path, or no shared memory
+        fmt::print(stderr, "{}\n", e.what());
+        return 1;
+    }
+    // a failed write stops the stream, not the simulation
+    auto const stream = [&emitter](ph::time t, std::span<ph::state const> states, std::span<ph::metadata const> forces) {
+        if (not emitter) {
+            return;
+        }
+        try {
+            emitter->step(t, states, forces);
+        } catch (std::system_error const & e) {
+            fmt::print(stderr, "{}: the stream is closed\n", e.what());
+            emitter.reset();
+        }
+    };
+    auto const close_stream = [&emitter] {
+        if (not emitter) {
+            return;
+        }
+        try {
+            emitter->flush();
+        } catch (std::system_error const & e) {
+            fmt::print(stderr, "{}: the last frames were not streamed\n", e.what());
+        }
+        emitter.reset();
+    };
+
+    auto recorder = std::unique_ptr<sym::trajectory_writer>{};
+    if (options.record) {
+        try {
+            recorder = std::make_unique<sym::trajectory_writer>(
+                *options.record,
+                sym::trajectory_options{.error_bound = *options.record_error * ph::m}
+            );
+        } catch (std::exception const & e) {  // a bad path or error bound
+            fmt::print(stderr, "{}\n", e.what());
+            return 1;
+        }
+    }
+    // a failed write stops the recording, not the simulation, and fails the run at the end
+    auto recording_failed = false;
+    auto const record = [&recorder, &recording_failed](ph::time t, std::span<ph::state const> states) {
+        if (not recorder) {
+            return;
+        }
+        try {
+            recorder->record(t, states);
+        } catch (std::system_error const & e) {
+            fmt::print(stderr, "{}: the recording is stopped\n", e.what());
+            recorder.reset();
+            recording_failed = true;
+        }
+    };
+    // the statistics go to stderr when stdout is the stream
+    auto const close_recording = [&recorder, &recording_failed, quiet] {
+        if (not recorder) {
+            return not recording_failed;
+        }
+        try {
+            recorder->flush();
+        } catch (std::system_error const & e) {
+            fmt::print(stderr, "{}: the recording is incomplete\n", e.what());
+            recorder.reset();
+            return false;
+        }
+        fmt::print(quiet ? stderr : stdout, "recorded {} frames in {} B ({:.1f}x smaller than raw)\n", recorder->frames(),
+            recorder->compressed_bytes(),
+            static_cast<double>(recorder->raw_bytes()) / static_cast<double>(std::max(recorder->compressed_bytes(), 1uz)));
+        recorder.reset();
+        return not recording_failed;
+    };
+
+    // the whole run at once, parallel in time, instead of the interactive one: only the states at the
+    // boundaries of the slices are kept
+    if (options.parareal) {
+        auto const result = sym::parareal(settings, rope, settings.t0, settings.t1, {
+            .slices = *options.parareal,
+            .coarse_dt = *options.parareal_dt * ph::s,
+            .tolerance = *options.parareal_tolerance * ph::m,
+        });
+        for (auto const & [t, boundary] : std::views::zip(result.times, result.boundaries)) {
+            stream(t, boundary, metadata);
+            record(t, boundary);
+        }
+        if (not quiet) {
+            fmt::print("parareal: {} slices, {} iterations, residual {} ({})\n", result.times.size() - 1,
+                result.iterations, result.residual, result.converged ? "converged" : "not converged");
+            fmt::print("{}\n", result.boundaries.back().back());
+        }
+        close_stream();
+        return close_recording() ? 0 : 1;
+    }
+
+    // the lowest natural frequencies of the initial rope, on stderr when stdout is the stream
+    if (options.modes) {
+        try {
+            for (auto const & [i, mode] : sym::natural_modes(settings, rope, *options.modes) | std::views::enumerate) {
+                fmt::print(quiet ? stderr : stdout, "mode {:>3}: {}\n", i + 1, mode.frequency);
+            }
+        } catch (std::exception const & e) {
+            fmt::print(stderr, "{}\n", e.what());
+            return 1;
+        }
+#ifdef NO_GRAPHICS
+        return 0;
+#endif
+    }
 
     /** UI stuff **/
     auto arrows_ui = gfx::arrows_ui{};
+#ifndef NO_GRAPHICS
+    auto modes_ui = gfx::modes_ui{settings, rope};
+#endif
 
     auto [quit, step] = std::array{false, false};
 
@@ -136,7 +372,15 @@ int main(int argc, char * argv[]) try  // NOLINT
     // auto manually_fixed = std::vector<ssize_t>{};  manually_fixed.reserve(5);
 
     auto const ΔT = 1. / settings.fps;
-    auto const δt = settings.dt;
+    auto watchdog = sym::watchdog{};
+    auto unstable = false;  // the watchdog could not make a step stable, which ends a headless run
+    // the result of each step, swapped with the rope to reuse the memory
+    auto step_result = ph::simulation_data{};
+
+    // allocations of the last frame, and whether the steps have already warmed up their buffers
+    auto allocations = sym::allocations::snapshot_t{};
+    auto warmed_up = false;
+    auto total_steps = std::size_t{0};
 
     using clock_t = std::chrono::system_clock;
     using duration_t = decltype(to_chrono_duration(ΔT));
@@ -144,7 +388,9 @@ int main(int argc, char * argv[]) try  // NOLINT
     auto begin = time_point_t(clock_t::now());
     auto pause = *options.pause ? std::optional<time_point_t>{begin} : std::nullopt;
     for (auto [t, event] = std::tuple{settings.t0, SDL_Event{}}; t < settings.t1 and not quit;) {
+        auto const frame_start = sym::allocations::snapshot();
 #ifndef NO_GRAPHICS
+        auto graphics_accounting = std::optional<sym::allocations::scope>{std::in_place, sym::allocations::subsystem::graphics};
         // clear the screen
         clear_screen();
 
@@ -320,10 +566,15 @@ int main(int argc, char * argv[]) try  // NOLINT
 #ifndef NO_GRAPHICS
         SDL_GetWindowSize(window.get(), &config.screen_size[0], &config.screen_size[1]);  // NOLINT
 
+        auto render_profile = std::optional<sym::profiler::zone>{std::in_place, sym::profiler::zone_id::render};
         // TODO: make a table with metadata relative to a bunch of selected points
-        auto const points = rope | std::views::transform(&ph::state::x);
-        gfx::render(points, settings.segment_length, config);
-        gfx::render(points, metadata, arrows_ui, config);
+        if (modes_ui.showing()) {
+            gfx::render(modes_ui.animated(ImGui::GetTime()), settings.segment_length, config);
+        } else {
+            auto const points = rope | std::views::transform(&ph::state::x);
+            gfx::render(points, settings.segment_length, config);
+            gfx::render(points, metadata, arrows_ui, config);
+        }
 
 
         /** IMGUI **/
@@ -334,10 +585,14 @@ int main(int argc, char * argv[]) try  // NOLINT
         ImGui::NewFrame();
 
 
-        gfx::draw_window("Data", data_ui(settings, config, rope, t, steps));
+        gfx::draw_window("Data", data_ui(settings, config, rope, t, steps, allocations));
         gfx::draw_window("Forces", forces_ui(settings, initial_settings));
         gfx::draw_window("Rope",  rope_editor_ui(settings, rope, metadata, t));
         gfx::draw_window("Graphics", arrows_ui);
+        gfx::draw_window("Modes", modes_ui);
+        if (sym::profiler::enabled()) {
+            gfx::draw_window("Profiler", gfx::profiler_ui_fn{rope.size(), total_steps});
+        }
 
         // ImGui::ShowDemoWindow();
 
@@ -347,25 +602,54 @@ int main(int argc, char * argv[]) try  // NOLINT
 
         // redraw
         update_screen();
+        render_profile.reset();
+        graphics_accounting.reset();
 #endif
 
         if (not pause or step) {
             auto const now = std::chrono::system_clock::now();
-            while (now - begin >= to_chrono_duration(ΔT)) {
+            auto stalled = false;
+            while (not stalled and now - begin >= to_chrono_duration(ΔT)) {
                 begin += to_chrono_duration(ΔT);
                 step = false;
                 // update the simulation
                 auto Δt = ph::duration::zero();
                 steps = 0;
-                for (; Δt < ΔT; Δt += δt) {
-                    auto res = sym::integrate(settings, rope, t + Δt, δt, get_metadata);
-                    rope = std::move(res.state);
-                    metadata = std::move(res.metadata);
+                // the rope and the settings may have been edited since the last batch
+                watchdog.forget();
+                // the watchdog may halve settings.dt, which is then the time-step actually used
+                auto const before = sym::allocations::count(sym::allocations::subsystem::simulation);
+                for (; Δt < ΔT; Δt += settings.dt) {
+                    if (not sym::guarded_integrate(settings, rope, t + Δt, watchdog, step_result, get_metadata)) {
+                        stalled = true;  // the rope is unchanged, and so is the time
+                        break;
+                    }
+                    std::swap(rope, step_result.state);
+                    std::swap(metadata, step_result.metadata);
                     ++steps;
+                    ++total_steps;
+                    stream(t + Δt + settings.dt, rope, metadata);
+                    record(t + Δt + settings.dt, rope);
                 }
                 t += Δt;
+                auto const allocated = sym::allocations::count(sym::allocations::subsystem::simulation) - before;
+                if (*options.check_allocations and warmed_up and allocated.allocations != 0) {
+                    fmt::print(stderr, "{} allocations ({} B) in {} steps at t = {}\n", allocated.allocations, allocated.bytes, steps, t);
+                    return 1;
+                }
+                warmed_up = true;
+            }
+            if (stalled) {
+#ifdef NO_GRAPHICS
+                quit = unstable = true;  // nothing can change the settings of a headless run
+#else
+                pause = clock_t::now();  // change the settings and resume
+#endif
             }
         }
+        if (publisher) {
+            publisher->publish(t, rope, metadata);
+        }
 
 #ifndef NO_GRAPHICS
         // TODO: does it still make sense to set fps?
@@ -374,13 +658,26 @@ int main(int argc, char * argv[]) try  // NOLINT
         //     std::this_thread::sleep_until(end);
         // }
 #endif
+        std::ranges::transform(sym::allocations::snapshot(), frame_start, allocations.begin(), std::minus{});
     }
+    close_stream();
+    auto const recorded = close_recording();
 #ifdef NO_GRAPHICS
-    fmt::print("{}\n", rope.back());  // avoid optimizing away the computation
+    if (not quiet) {
+        fmt::print("{}\n", rope.back());  // avoid optimizing away the computation
+    }
+    if (sym::profiler::enabled()) {
+        sym::profiler::report(rope.size(), total_steps);
+    }
 #endif
+    // in total and per step, to compare the runs of a benchmark
+    if constexpr (sym::allocations::enabled) {
+        sym::allocations::report(total_steps);
+    }
+    return unstable or not recorded ? 1 : 0;
 } catch (structopt::exception const & e) {
-    fmt::print("{}\n", e.what());
-    fmt::print("{}\n", e.help());
+    fmt::print(stderr, "{}\n", e.what());
+    fmt::print(stderr, "{}\n", e.help());
 }
 
 // cmake --build build --preset conan-release && time build/build/Release/ropes -n=200 --dt=0.001 --duration=25
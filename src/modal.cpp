@@ -0,0 +1,255 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : modal
+ * @created     : Friday Oct 23, 2026 15:24:02 CEST
+ * @description :
+ */
+
+#include "modal.hpp"
+#include "equilibrium.hpp"
+#include "allocations.hpp"
+#include <mp-units/math.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <ranges>
+#include <stdexcept>
+
+namespace sym
+{
+
+namespace
+{
+auto dot(std::span<double const> const a, std::span<double const> const b) -> double
+{
+    return std::ranges::fold_left(std::views::zip_transform(std::multiplies{}, a, b), 0., std::plus{});
+}
+
+/**
+ * Replaces the symmetric tridiagonal matrix of diagonal `d` and off diagonal `e` (`e[i]` joins the
+ * rows i and i + 1) with its eigenvalues in `d`, and returns the eigenvectors as the columns of a
+ * row major matrix. Implicit QL with Wilkinson shifts.
+ */
+auto tridiagonal_eigen(std::vector<double> & d, std::vector<double> e) -> std::vector<double>
+{
+    auto const n = std::ssize(d);
+    auto z = std::vector<double>(static_cast<std::size_t>(n * n), 0.);
+    for (auto i = std::ptrdiff_t{0}; i < n; ++i) {
+        z[i * n + i] = 1.;
+    }
+    e.resize(d.size(), 0.);
+    e.back() = 0.;
+
+    for (auto l = std::ptrdiff_t{0}; l < n; ++l) {
+        auto m = l;
+        for (auto iteration = 0; iteration < 60; ++iteration) {
+            // the first negligible off diagonal element splits the matrix
+            for (m = l; m + 1 < n; ++m) {
+                if (std::abs(e[m]) <= std::numeric_limits<double>::epsilon() * (std::abs(d[m]) + std::abs(d[m + 1]))) {
+                    break;
+                }
+            }
+            if (m == l) {
+                break;
+            }
+            auto g = (d[l + 1] - d[l]) / (2. * e[l]);
+            auto r = std::hypot(g, 1.);
+            g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+            auto s = 1.;
+            auto c = 1.;
+            auto p = 0.;
+            auto i = m - 1;
+            for (; i >= l; --i) {
+                auto const f = s * e[i];
+                auto const b = c * e[i];
+                r = std::hypot(f, g);
+                e[i + 1] = r;
+                if (r == 0.) {
+                    d[i + 1] -= p;
+                    e[m] = 0.;
+                    break;
+                }
+                s = f / r;
+                c = g / r;
+                g = d[i + 1] - p;
+                r = (d[i] - g) * s + 2. * c * b;
+                p = s * r;
+                d[i + 1] = g + p;
+                g = c * r - b;
+                for (auto k = std::ptrdiff_t{0}; k < n; ++k) {
+                    auto const t = z[k * n + i + 1];
+                    z[k * n + i + 1] = s * z[k * n + i] + c * t;
+                    z[k * n + i] = c * z[k * n + i] - s * t;
+                }
+            }
+            if (r == 0. and i >= l) {
+                continue;
+            }
+            d[l] -= p;
+            e[l] = g;
+            e[m] = 0.;
+        }
+    }
+    return z;
+}
+
+struct eigenpairs
+{
+    std::vector<double> values;
+    std::vector<std::vector<double>> vectors;
+};
+
+/**
+ * The `count` eigenvalues of largest magnitude of the inverse of a factorized symmetric matrix, and
+ * their eigenvectors, restricted to the unknowns where `free` is set: Lanczos iteration with full
+ * reorthogonalization, stopped when the residuals of all the wanted Ritz pairs are negligible
+ */
+auto largest_of_inverse(
+    math::banded_matrix<double> const & factorized, std::vector<bool> const & free, std::size_t count
+) -> eigenpairs
+{
+    constexpr auto tolerance = 1e-10;
+    auto const size = free.size();
+    auto const unknowns = static_cast<std::size_t>(std::ranges::count(free, true));
+    count = std::min(count, unknowns);
+    if (count == 0) {
+        return {};
+    }
+
+    auto const restrict = [&](std::span<double> v) {
+        for (auto i = 0uz; i < size; ++i) {
+            v[i] = free[i] ? v[i] : 0.;
+        }
+    };
+
+    // a fixed seed, so that the same rope always gives the same modes
+    auto generator = std::mt19937_64{42};
+    auto uniform = std::uniform_real_distribution{-1., 1.};
+    auto v = std::vector<double>(size);
+    std::ranges::generate(v, [&] { return uniform(generator); });
+    restrict(v);
+    std::ranges::transform(v, v.begin(), [norm = std::sqrt(dot(v, v))](double x) { return x / norm; });
+
+    auto basis = std::vector<std::vector<double>>{};
+    auto alpha = std::vector<double>{};
+    auto beta = std::vector<double>{};
+    auto w = std::vector<double>(size);
+    while (true) {
+        basis.push_back(v);
+        std::ranges::copy(v, w.begin());
+        factorized.solve(w);
+        restrict(w);
+        alpha.push_back(dot(w, v));
+        // twice is enough to keep the basis orthogonal to the working precision
+        for (auto pass = 0; pass < 2; ++pass) {
+            for (auto const & q : basis) {
+                auto const projection = dot(w, q);
+                std::ranges::transform(w, q, w.begin(), [projection](double a, double b) { return a - projection * b; });
+            }
+        }
+        auto const norm = std::sqrt(dot(w, w));
+        auto const steps = basis.size();
+
+        auto const exhausted = steps == unknowns or norm <= tolerance * std::abs(alpha.back());
+        if (steps >= count and (exhausted or steps % 8 == 0)) {
+            auto values = alpha;
+            auto const z = tridiagonal_eigen(values, beta);
+            auto order = std::views::iota(0uz, steps) | std::ranges::to<std::vector>();
+            std::ranges::sort(order, std::greater{}, [&](auto i) { return std::abs(values[i]); });
+            order.resize(count);
+            // the residual of a Ritz pair is the norm of the next vector times the last component
+            auto const converged = std::ranges::all_of(order, [&](auto i) {
+                return norm * std::abs(z[(steps - 1) * steps + i]) <= tolerance * std::abs(values[i]);
+            });
+            if (converged or exhausted) {
+                auto result = eigenpairs{};
+                for (auto const i : order) {
+                    auto vector = std::vector<double>(size, 0.);
+                    for (auto j = 0uz; j < steps; ++j) {
+                        auto const weight = z[j * steps + i];
+                        std::ranges::transform(vector, basis[j], vector.begin(), [weight](double a, double b) { return a + weight * b; });
+                    }
+                    result.values.push_back(values[i]);
+                    result.vectors.push_back(std::move(vector));
+                }
+                return result;
+            }
+        }
+        beta.push_back(norm);
+        std::ranges::transform(w, v.begin(), [norm](double x) { return x / norm; });
+    }
+}
+}  // namespace
+
+auto natural_modes(
+    sym::settings const & settings, std::span<ph::state const> rope, int count
+) -> std::vector<sym::mode>
+{
+    auto const accounting = sym::allocations::scope{sym::allocations::subsystem::simulation};
+    auto const n = std::ssize(rope);
+    if (count <= 0 or n == 0) {
+        return {};
+    }
+
+    // at rest, so that the damping does not enter the stiffness
+    auto states = rope | std::ranges::to<std::vector>();
+    for (auto & s : states) {
+        s.v = ph::velocity::zero();
+    }
+    auto const jacobian = sym::acceleration_jacobian(settings, states);
+    auto const bandwidth = jacobian.bandwidth();
+    auto const free = std::views::iota(std::ptrdiff_t{0}, 2 * n)
+        | std::views::transform([&](auto p) { return not states[p / 2].fixed; })
+        | std::ranges::to<std::vector>();
+    auto const root_mass = std::views::iota(std::ptrdiff_t{0}, 2 * n)
+        | std::views::transform([&](auto p) { return std::sqrt(states[p / 2].m.numerical_value_in(ph::kg)); })
+        | std::ranges::to<std::vector>();
+
+    // M^½ K M^-½ with K = -M J, symmetric but for the errors of the finite differences; the fixed
+    // unknowns are decoupled, with a unit diagonal
+    auto stiffness = math::banded_matrix<double>(2 * n, bandwidth);
+    auto scale = 0.;
+    for (auto p = std::ptrdiff_t{0}; p < 2 * n; ++p) {
+        for (auto q = p - bandwidth; q <= p + bandwidth; ++q) {
+            if (not stiffness.in_band(p, q) or not free[p] or not free[q]) {
+                continue;
+            }
+            stiffness(p, q) = -(jacobian(p, q) * root_mass[p] / root_mass[q] + jacobian(q, p) * root_mass[q] / root_mass[p]) / 2.;
+        }
+        scale = std::max(scale, std::abs(stiffness(p, p)));
+    }
+    // a tiny positive shift, K + σI, keeps the factorization regular with the zero frequencies of a
+    // free rope; it is subtracted back from the eigenvalues
+    auto const shift = 1e-9 * std::max(scale, 1.);
+    for (auto p = std::ptrdiff_t{0}; p < 2 * n; ++p) {
+        stiffness(p, p) = free[p] ? stiffness(p, p) + shift : 1.;
+    }
+    if (not stiffness.factorize()) {
+        throw std::runtime_error{"cannot factorize the stiffness of the rope"};
+    }
+
+    auto const pairs = largest_of_inverse(stiffness, free, static_cast<std::size_t>(count));
+    auto modes = std::vector<sym::mode>{};
+    for (auto const & [value, vector] : std::views::zip(pairs.values, pairs.vectors)) {
+        auto const omega_squared = 1. / value - shift;
+        auto shape = std::views::iota(std::ptrdiff_t{0}, n)
+            | std::views::transform([&](auto i) {
+                return ph::vector<>{vector[2 * i] / root_mass[2 * i], vector[2 * i + 1] / root_mass[2 * i + 1]};
+            })
+            | std::ranges::to<std::vector>();
+        auto const largest = std::ranges::max(shape | std::views::transform(math::norm));
+        for (auto & d : shape) {
+            d /= largest;
+        }
+        modes.push_back({
+            std::sqrt(std::max(omega_squared, 0.)) / (2 * std::numbers::pi) * ph::Hz,
+            std::move(shape)
+        });
+    }
+    std::ranges::sort(modes, {}, &sym::mode::frequency);
+    return modes;
+}
+
+}  // namespace sym
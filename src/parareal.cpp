@@ -0,0 +1,161 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : parareal
+ * @created     : Thursday Oct 22, 2026 17:03:55 CEST
+ * @description :
+ */
+
+#include "parareal.hpp"
+#include "scheduler.hpp"
+#include "allocations.hpp"
+#include <mp-units/math.h>
+#include <algorithm>
+#include <cmath>
+#include <ranges>
+
+namespace sym
+{
+
+namespace
+{
+// the number of equal steps of at most `dt` covering `span`
+auto steps_over(ph::duration span, ph::duration dt) -> int
+{
+    return std::max(1, static_cast<int>(std::ceil((span / dt).numerical_value_in(mp_units::one))));
+}
+
+/** The coarse propagator: symplectic Euler, reusing its buffers across the slices */
+class coarse_propagator
+{
+    sym::settings const & _settings;
+    ph::duration _dt;
+    std::vector<sym::segment> _segments;
+    std::vector<ph::derivative> _derivatives;
+
+public:
+    coarse_propagator(sym::settings const & settings, std::size_t n_points, ph::duration dt)
+        : _settings{settings}, _dt{dt}, _segments(n_points == 0 ? 0 : n_points - 1), _derivatives(n_points)
+    {}
+
+    auto operator()(std::span<ph::state const> from, ph::time t, ph::duration span) -> std::vector<ph::state>
+    {
+        auto rope = std::vector<ph::state>(from.begin(), from.end());
+        auto const steps = steps_over(span, _dt);
+        auto const h = span / steps;
+        auto & pool = sym::scheduler::global();
+        for (auto i = 0; i < steps; ++i) {
+            sym::evaluate(_settings, rope, _segments, _derivatives, t + i * h);
+            pool.parallel_for(0, std::ssize(rope), sym::parallel_grain, [&](auto first, auto last) {
+                for (auto j = first; j < last; ++j) {
+                    // the position moves with the new velocity
+                    rope[j].v += _derivatives[j].dv * h;
+                    rope[j].x += rope[j].v * h;
+                }
+            });
+        }
+        return rope;
+    }
+};
+
+/** The fine propagator: the steps of the sequential integration */
+auto fine_propagator(
+    sym::settings const & settings, std::span<ph::state const> from, ph::time t, ph::duration span
+) -> std::vector<ph::state>
+{
+    auto const steps = steps_over(span, settings.dt);
+    auto const h = span / steps;
+    auto rope = sym::memory::vector<ph::state>(from.begin(), from.end());
+    auto step = ph::simulation_data{};
+    for (auto i = 0; i < steps; ++i) {
+        sym::integrate(settings, rope, t + i * h, h, step);
+        std::swap(rope, step.state);
+    }
+    return {rope.begin(), rope.end()};
+}
+
+// the new coarse prediction, corrected by the difference between the fine and the coarse results of
+// the last iteration
+auto correct(
+    std::span<ph::state const> predicted, std::span<ph::state const> fine, std::span<ph::state const> previous
+) -> std::vector<ph::state>
+{
+    auto rope = std::vector<ph::state>(predicted.begin(), predicted.end());
+    for (auto && [s, f, p] : std::views::zip(rope, fine, previous)) {
+        s.x += f.x - p.x;
+        s.v += f.v - p.v;
+    }
+    return rope;
+}
+
+auto largest_change(std::span<ph::state const> a, std::span<ph::state const> b) -> ph::length
+{
+    auto const distance = [](ph::state const & s, ph::state const & r) { return math::norm(s.x - r.x); };
+    return std::ranges::max(std::views::zip_transform(distance, a, b));
+}
+}  // namespace
+
+auto parareal(
+    sym::settings const & settings, std::span<ph::state const> rope, ph::time t0, ph::time t1,
+    sym::parareal_options const & options
+) -> sym::parareal_result
+{
+    auto const accounting = sym::allocations::scope{sym::allocations::subsystem::simulation};
+    auto & pool = sym::scheduler::global();
+    auto const slices = options.slices > 0 ? options.slices : static_cast<int>(pool.size()) + 1;
+    auto const max_iterations = options.max_iterations > 0 ? std::min(options.max_iterations, slices) : slices;
+    // the coarse propagator integrates all the forces together, even if the fine one substeps some
+    auto const coarse_dt = options.coarse_dt > ph::duration::zero() ? options.coarse_dt : [&] {
+        auto single_rate = settings;
+        single_rate.substeps = 1;
+        return std::max(settings.dt, sym::stable_timestep(single_rate));
+    }();
+    auto const span = (t1 - t0) / slices;
+
+    auto result = sym::parareal_result{};
+    result.times = std::views::iota(0, slices + 1)
+        | std::views::transform([&](int n) { return n == slices ? t1 : t0 + n * span; })
+        | std::ranges::to<std::vector>();
+    auto & u = result.boundaries;
+    u.resize(static_cast<std::size_t>(slices) + 1);
+    u[0].assign(rope.begin(), rope.end());
+
+    // the first guess: a coarse sweep, whose results at the end of each slice are kept for the corrections
+    auto coarse = coarse_propagator{settings, rope.size(), coarse_dt};
+    auto predicted = std::vector<std::vector<ph::state>>(u.size());
+    for (auto n = 0uz; n + 1 < u.size(); ++n) {
+        predicted[n + 1] = coarse(u[n], result.times[n], span);
+        u[n + 1] = predicted[n + 1];
+    }
+
+    auto fine = std::vector<std::vector<ph::state>>(u.size());
+    for (auto k = 0; k < max_iterations; ++k) {
+        // the slices before k are already exact
+        pool.parallel_for(k, slices, 1, [&](auto first, auto last) {
+            for (auto n = static_cast<std::size_t>(first); n < static_cast<std::size_t>(last); ++n) {
+                fine[n + 1] = fine_propagator(settings, u[n], result.times[n], span);
+            }
+        });
+
+        // the slice k starts from an exact state, so its fine result is exact too
+        auto const first = static_cast<std::size_t>(k) + 1;
+        auto residual = largest_change(fine[first], u[first]);
+        u[first] = fine[first];
+        for (auto n = first; n + 1 < u.size(); ++n) {
+            auto next = coarse(u[n], result.times[n], span);
+            auto corrected = correct(next, fine[n + 1], predicted[n + 1]);
+            residual = std::max(residual, largest_change(corrected, u[n + 1]));
+            u[n + 1] = std::move(corrected);
+            predicted[n + 1] = std::move(next);
+        }
+
+        result.iterations = k + 1;
+        result.residual = residual;
+        if (residual <= options.tolerance or result.iterations == slices) {
+            result.converged = true;
+            break;
+        }
+    }
+    return result;
+}
+
+}  // namespace sym
@@ -0,0 +1,236 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : profiler
+ * @created     : Saturday Oct 17, 2026 20:37:52 CEST
+ * @description : 
+ */
+
+#include "profiler.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace sym::profiler
+{
+
+namespace detail
+{
+std::atomic<bool> enabled = false;
+}
+
+namespace
+{
+struct totals
+{
+    std::atomic<std::uint64_t> calls = 0;
+    std::array<std::atomic<std::uint64_t>, events.size()> values{};
+};
+
+std::array<totals, zones.size()> zone_totals;
+
+/**
+ * The counters of a thread, opened at the first zone as a single group, so that they are all read
+ * with one system call and refer to the same interval
+ */
+class counter_group
+{
+    int _leader = -1;
+    std::array<int, events.size()> _fds = {-1, -1, -1, -1, -1};
+
+public:
+    counter_group();
+    ~counter_group();
+
+    counter_group(counter_group const &) = delete;
+    counter_group(counter_group &&) = delete;
+    auto operator=(counter_group const &) -> counter_group & = delete;
+    auto operator=(counter_group &&) -> counter_group & = delete;
+
+    [[nodiscard]] auto valid() const noexcept { return _leader != -1; }
+    [[nodiscard]] auto available(event e) const noexcept { return _fds[std::to_underlying(e)] != -1; }
+    [[nodiscard]] auto read() const noexcept -> counts;
+};
+
+#ifdef __linux__
+auto open_counter(perf_event_attr attr, int group) noexcept -> int
+{
+    attr.size = sizeof(attr);
+    attr.disabled = group == -1 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+}
+
+auto attributes(event e) noexcept -> perf_event_attr
+{
+    auto attr = perf_event_attr{};
+    switch (e) {
+    case event::cycles:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case event::instructions:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case event::l1d_misses:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D
+                    | (PERF_COUNT_HW_CACHE_OP_READ << 8U)
+                    | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U);
+        break;
+    case event::llc_misses:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case event::branch_misses:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    }
+    return attr;
+}
+
+counter_group::counter_group()
+{
+    // the first event that can be opened leads the group; the others are optional
+    for (auto const e : events) {
+        auto const fd = open_counter(attributes(e), _leader);
+        _fds[std::to_underlying(e)] = fd;
+        if (_leader == -1) {
+            _leader = fd;
+        }
+    }
+    if (_leader != -1) {
+        ::ioctl(_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);  // NOLINT(*-vararg)
+        ::ioctl(_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);  // NOLINT(*-vararg)
+    }
+}
+
+counter_group::~counter_group()
+{
+    for (auto const fd : _fds) {
+        if (fd != -1) {
+            ::close(fd);
+        }
+    }
+}
+
+auto counter_group::read() const noexcept -> counts
+{
+    auto result = counts{};
+    if (_leader == -1) {
+        return result;
+    }
+    // with PERF_FORMAT_GROUP: the number of counters, then their values in opening order
+    auto buffer = std::array<std::uint64_t, events.size() + 1>{};
+    if (::read(_leader, buffer.data(), sizeof(buffer)) <= 0) {
+        return result;
+    }
+    auto next = std::size_t{1};
+    for (auto const e : events) {
+        if (available(e) and next <= buffer[0]) {
+            result[std::to_underlying(e)] = buffer[next++];
+        }
+    }
+    return result;
+}
+#else
+counter_group::counter_group() = default;
+counter_group::~counter_group() = default;
+auto counter_group::read() const noexcept -> counts { return {}; }
+#endif
+
+auto thread_counters() -> counter_group const &
+{
+    thread_local auto const group = counter_group{};
+    return group;
+}
+}  // namespace
+
+auto enable(bool on) -> bool
+{
+    detail::enabled.store(on and thread_counters().valid(), std::memory_order_relaxed);
+    return enabled() == on;
+}
+
+auto read(zone_id z) noexcept -> result
+{
+    auto const & totals = zone_totals[std::to_underlying(z)];
+    auto r = result{.calls = totals.calls.load(std::memory_order_relaxed)};
+    for (auto const e : events) {
+        auto const idx = std::to_underlying(e);
+        r.values[idx] = totals.values[idx].load(std::memory_order_relaxed);
+        r.available[idx] = thread_counters().available(e);
+    }
+    return r;
+}
+
+void reset() noexcept
+{
+    for (auto & totals : zone_totals) {
+        totals.calls.store(0, std::memory_order_relaxed);
+        for (auto & value : totals.values) {
+            value.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+zone::zone(zone_id id) noexcept : _id{id}, _active{enabled()}, _start{}
+{
+    if (_active) {
+        _start = thread_counters().read();
+    }
+}
+
+zone::~zone()
+{
+    if (not _active) {
+        return;
+    }
+    auto const end = thread_counters().read();
+    auto & totals = zone_totals[std::to_underlying(_id)];
+    totals.calls.fetch_add(1, std::memory_order_relaxed);
+    for (auto i = 0uz; i < end.size(); ++i) {
+        totals.values[i].fetch_add(end[i] - _start[i], std::memory_order_relaxed);
+    }
+}
+
+void report(std::size_t points, std::size_t steps)
+{
+    auto const point_steps = static_cast<double>(std::max(points * steps, std::size_t{1}));
+    fmt::print(stderr, "{:<18} {:>10} {:>14}", "Zone", "Calls", "Per");
+    for (auto const e : events) {
+        fmt::print(stderr, " {:>14}", name(e));
+    }
+    fmt::print(stderr, " {:>8}\n", "IPC");
+    for (auto const z : zones) {
+        auto const r = read(z);
+        if (r.calls == 0) {
+            continue;
+        }
+        auto const scale = 1. / (per_point(z) ? point_steps : static_cast<double>(r.calls));
+        fmt::print(stderr, "{:<18} {:>10} {:>14}", name(z), r.calls, per_point(z) ? "point and step" : "call");
+        for (auto const e : events) {
+            auto const idx = std::to_underlying(e);
+            if (r.available[idx]) {
+                fmt::print(stderr, " {:>14.3f}", static_cast<double>(r.values[idx]) * scale);
+            } else {
+                fmt::print(stderr, " {:>14}", "n/a");
+            }
+        }
+        auto const cycles = r.values[std::to_underlying(event::cycles)];
+        auto const instructions = r.values[std::to_underlying(event::instructions)];
+        fmt::print(stderr, " {:>8.2f}\n", cycles == 0 ? 0. : static_cast<double>(instructions) / static_cast<double>(cycles));
+    }
+}
+
+}  // namespace sym::profiler
@@ -0,0 +1,122 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : publisher
+ * @created     : Sunday Oct 18, 2026 09:58:27 CEST
+ * @description : 
+ */
+
+#include "publisher.hpp"
+#include "ropes_shm.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace sym
+{
+
+namespace
+{
+constexpr auto cache_line = std::size_t{64};
+
+auto slot_stride(std::size_t capacity) noexcept -> std::size_t
+{
+    auto const bytes = sizeof(ropes_shm_frame) + capacity * sizeof(ropes_shm_point);
+    return (bytes + cache_line - 1) / cache_line * cache_line;
+}
+
+auto header_of(void * memory) noexcept
+{
+    return static_cast<ropes_shm_header *>(memory);
+}
+
+auto frame_at(void * memory, std::size_t slot) noexcept
+{
+    auto * const bytes = static_cast<std::byte *>(memory);
+    auto const stride = header_of(memory)->slot_stride;
+    return reinterpret_cast<ropes_shm_frame *>(bytes + ROPES_SHM_FRAMES_OFFSET + slot * stride);  // NOLINT
+}
+}  // namespace
+
+shm_publisher::shm_publisher(std::string name, std::size_t capacity, std::uint32_t slots)
+    : _name{std::move(name)},
+      _size{ROPES_SHM_FRAMES_OFFSET + std::max(slots, 1U) * slot_stride(capacity)}
+{
+    static_assert(sizeof(ropes_shm_header) <= ROPES_SHM_FRAMES_OFFSET);
+    auto const fd = ::shm_open(_name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);  // NOLINT(*-vararg)
+    if (fd == -1) {
+        throw std::system_error{errno, std::system_category(), "shm_open " + _name};
+    }
+    if (::ftruncate(fd, static_cast<off_t>(_size)) == -1) {
+        auto const error = errno;
+        ::close(fd);
+        ::shm_unlink(_name.c_str());
+        throw std::system_error{error, std::system_category(), "ftruncate " + _name};
+    }
+    _memory = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (_memory == MAP_FAILED) {
+        auto const error = errno;
+        ::shm_unlink(_name.c_str());
+        throw std::system_error{error, std::system_category(), "mmap " + _name};
+    }
+
+    // the memory is zeroed by ftruncate: latest = 0 and all the sequences even
+    auto * const header = header_of(_memory);
+    header->version = ROPES_SHM_VERSION;
+    header->slots = std::max(slots, 1U);
+    header->capacity = capacity;
+    header->slot_stride = slot_stride(capacity);
+    // written last: readers check it before trusting the rest
+    std::atomic_ref{header->magic}.store(ROPES_SHM_MAGIC, std::memory_order_release);
+}
+
+shm_publisher::~shm_publisher()
+{
+    ::munmap(_memory, _size);
+    // the readers keep their mappings
+    ::shm_unlink(_name.c_str());
+}
+
+void shm_publisher::publish(
+    ph::time t, std::span<ph::state const> rope, std::span<ph::metadata const> metadata
+)
+{
+    auto * const header = header_of(_memory);
+    auto const generation = header->latest + 1;  // only this thread writes it
+    auto * const frame = frame_at(_memory, (generation - 1) % header->slots);
+
+    auto sequence = std::atomic_ref{frame->sequence};
+    auto const start = sequence.load(std::memory_order_relaxed);
+    sequence.store(start + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto const n_points = std::min(rope.size(), header->capacity);
+    frame->generation = generation;
+    frame->time = t.numerical_value_in(ph::s);
+    frame->n_points = n_points;
+    frame->total_points = rope.size();
+    auto * const points = reinterpret_cast<ropes_shm_point *>(frame + 1);  // NOLINT
+    for (auto i = 0uz; i < n_points; ++i) {
+        auto const & x = rope[i].x;
+        auto const & v = rope[i].v;
+        auto const force = i < metadata.size() ? metadata[i].total : ph::force::zero();
+        points[i] = ropes_shm_point{
+            .x = x[0].numerical_value_in(ph::m),
+            .y = x[1].numerical_value_in(ph::m),
+            .vx = v[0].numerical_value_in(ph::m / ph::s),
+            .vy = v[1].numerical_value_in(ph::m / ph::s),
+            .fx = force[0].numerical_value_in(ph::N),
+            .fy = force[1].numerical_value_in(ph::N)
+        };
+    }
+
+    sequence.store(start + 2, std::memory_order_release);
+    std::atomic_ref{header->latest}.store(generation, std::memory_order_release);
+}
+
+}  // namespace sym
@@ -0,0 +1,208 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : scheduler
+ * @created     : Saturday Oct 17, 2026 16:20:51 CEST
+ * @description : 
+ */
+
+#include "scheduler.hpp"
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace sym
+{
+
+namespace
+{
+// the pool the current thread works for, if any, and its index inside the pool
+thread_local scheduler const * current_pool = nullptr;
+thread_local std::size_t current_worker = 0;
+
+struct
+{
+    std::size_t workers = 0;
+    bool pin_threads = false;
+} global_config;
+
+void pin_to_core([[maybe_unused]] std::thread & thread, [[maybe_unused]] std::size_t core)
+{
+#ifdef __linux__
+    auto set = cpu_set_t{};
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#endif
+}
+}  // namespace
+
+scheduler::scheduler(std::size_t workers, bool pin_threads)
+{
+    _workers.reserve(workers);
+    for (auto i = 0uz; i < workers; ++i) {
+        _workers.push_back(std::make_unique<worker>());
+    }
+    auto const cores = std::max(std::thread::hardware_concurrency(), 1u);
+    for (auto i = 0uz; i < workers; ++i) {
+        auto & thread = _workers[i]->thread;
+        thread = std::thread{&scheduler::work, this, i};
+        if (pin_threads) {
+            // the first core is left to the main thread
+            pin_to_core(thread, (i + 1) % cores);
+        }
+    }
+}
+
+scheduler::~scheduler()
+{
+    {
+        auto lock = std::scoped_lock{_sleep_mutex};
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (auto & w : _workers) {
+        w->thread.join();
+    }
+}
+
+void scheduler::configure(std::size_t workers, bool pin_threads)
+{
+    global_config.workers = workers;
+    global_config.pin_threads = pin_threads;
+}
+
+auto scheduler::global() -> scheduler &
+{
+    static auto pool = scheduler{
+        global_config.workers != 0
+            ? global_config.workers
+            : std::max(std::thread::hardware_concurrency(), 1u) - 1,
+        global_config.pin_threads
+    };
+    return pool;
+}
+
+void scheduler::push(std::mutex & mutex, std::deque<task> & tasks, task t)
+{
+    {
+        auto lock = std::scoped_lock{mutex};
+        tasks.push_back(std::move(t));
+    }
+    {
+        auto lock = std::scoped_lock{_sleep_mutex};
+        _queued.fetch_add(1, std::memory_order_relaxed);
+    }
+    _wake.notify_all();
+}
+
+void scheduler::submit(task t)
+{
+    if (current_pool == this) {
+        auto & w = *_workers[current_worker];
+        push(w.mutex, w.tasks, std::move(t));
+    } else {
+        push(_shared_mutex, _shared, std::move(t));
+    }
+}
+
+void scheduler::submit(task t, std::size_t worker)
+{
+    if (_workers.empty()) {
+        push(_shared_mutex, _shared, std::move(t));
+        return;
+    }
+    auto & w = *_workers[worker % _workers.size()];
+    push(w.mutex, w.tasks, std::move(t));
+}
+
+auto scheduler::pop(task & t) -> bool
+{
+    if (_queued.load(std::memory_order_relaxed) <= 0) {
+        return false;
+    }
+    auto const take = [&t](std::mutex & mutex, std::deque<task> & tasks, bool from_back) {
+        auto lock = std::scoped_lock{mutex};
+        if (tasks.empty()) {
+            return false;
+        }
+        if (from_back) {
+            t = std::move(tasks.back());
+            tasks.pop_back();
+        } else {
+            t = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        return true;
+    };
+
+    auto const n = _workers.size();
+    auto const self = current_pool == this ? current_worker : n;
+    // the newest task of our own deque is the most likely to be in cache, then the oldest tasks
+    // of the others: they are the biggest ones in a recursive split
+    auto found = self < n and take(_workers[self]->mutex, _workers[self]->tasks, true);
+    found = found or take(_shared_mutex, _shared, false);
+    for (auto i = 1uz; not found and i <= n; ++i) {
+        auto const victim = (self + i) % n;
+        found = victim != self and take(_workers[victim]->mutex, _workers[victim]->tasks, false);
+    }
+    if (found) {
+        _queued.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return found;
+}
+
+auto scheduler::run_one() -> bool
+{
+    auto t = task{};
+    if (not pop(t)) {
+        return false;
+    }
+    t();
+    return true;
+}
+
+void scheduler::work(std::size_t id)
+{
+    current_pool = this;
+    current_worker = id;
+    auto t = task{};
+    while (true) {
+        if (pop(t)) {
+            t();
+            t = nullptr;
+            continue;
+        }
+        auto lock = std::unique_lock{_sleep_mutex};
+        _wake.wait(lock, [this] { return _stop or _queued.load(std::memory_order_relaxed) > 0; });
+        if (_stop and _queued.load(std::memory_order_relaxed) <= 0) {
+            return;
+        }
+    }
+}
+
+task_group::~task_group()
+{
+    while (_pending.load(std::memory_order_acquire) > 0) {
+        if (not _pool.run_one()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void task_group::wait()
+{
+    while (_pending.load(std::memory_order_acquire) > 0) {
+        if (not _pool.run_one()) {
+            std::this_thread::yield();
+        }
+    }
+    auto lock = std::scoped_lock{_error_mutex};
+    if (_error) {
+        std::rethrow_exception(std::exchange(_error, nullptr));
+    }
+}
+
+}  // namespace sym
@@ -0,0 +1,207 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : shape_cache
+ * @created     : Monday Oct 19, 2026 18:02:44 CEST
+ * @description :
+ */
+
+#include "shape_cache.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <unistd.h>
+
+namespace sym
+{
+
+namespace
+{
+constexpr auto file_magic = std::array{'R', 'O', 'P', 'S'};
+// bumped whenever the points of the same formulas change: parser, sampler or layout
+constexpr auto file_version = std::uint32_t{3};
+
+auto fnv1a(std::string const & text) noexcept -> std::uint64_t
+{
+    auto hash = std::uint64_t{0xcbf29ce484222325};
+    for (auto const c : text) {
+        hash = (hash ^ static_cast<std::uint8_t>(c)) * 0x100000001b3;
+    }
+    return hash;
+}
+
+template <typename T>
+void write_le(std::ostream & out, T value)
+{
+    using bits_t = std::conditional_t<sizeof(T) == 8, std::uint64_t, std::uint32_t>;
+    auto bits = std::bit_cast<bits_t>(value);
+    if constexpr (std::endian::native == std::endian::big) {
+        bits = std::byteswap(bits);
+    }
+    out.write(reinterpret_cast<char const *>(&bits), sizeof(bits));
+}
+
+template <typename T>
+auto read_le(std::istream & in) -> T
+{
+    using bits_t = std::conditional_t<sizeof(T) == 8, std::uint64_t, std::uint32_t>;
+    auto bits = bits_t{};
+    in.read(reinterpret_cast<char *>(&bits), sizeof(bits));
+    if constexpr (std::endian::native == std::endian::big) {
+        bits = std::byteswap(bits);
+    }
+    return std::bit_cast<T>(bits);
+}
+
+auto read_file(std::filesystem::path const & path, std::string const & key) -> std::optional<shape_cache::points>
+{
+    auto in = std::ifstream{path, std::ios::binary};
+    auto magic = std::array<char, 4>{};
+    if (not in.read(magic.data(), magic.size()) or magic != file_magic or read_le<std::uint32_t>(in) != file_version) {
+        return std::nullopt;
+    }
+    if (read_le<std::uint64_t>(in) != key.size()) {
+        return std::nullopt;
+    }
+    auto stored_key = std::string(key.size(), '\0');
+    if (not in.read(stored_key.data(), std::ssize(stored_key)) or stored_key != key) {
+        return std::nullopt;  // a hash collision
+    }
+    auto const size = read_le<std::uint64_t>(in);
+    auto error = std::error_code{};
+    if (not in or size > std::filesystem::file_size(path, error) / (2 * sizeof(double))) {
+        return std::nullopt;
+    }
+    auto shape = shape_cache::points(size);
+    for (auto & p : shape) {
+        p = math::vector<double, 2>{read_le<double>(in), read_le<double>(in)};
+    }
+    return in ? std::optional{std::move(shape)} : std::nullopt;
+}
+
+void write_file(std::filesystem::path const & path, std::string const & key, shape_cache::points const & shape)
+{
+    // written aside and renamed, so a reader never sees half a file
+    auto const temporary = std::filesystem::path{path} += fmt::format(".{}", ::getpid());
+    {
+        auto out = std::ofstream{temporary, std::ios::binary | std::ios::trunc};
+        out.write(file_magic.data(), file_magic.size());
+        write_le(out, file_version);
+        write_le(out, std::uint64_t{key.size()});
+        out.write(key.data(), std::ssize(key));
+        write_le(out, std::uint64_t{shape.size()});
+        for (auto const & p : shape) {
+            write_le(out, p[0]);
+            write_le(out, p[1]);
+        }
+        if (not out.flush()) {
+            auto error = std::error_code{};
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+    }
+    auto error = std::error_code{};
+    std::filesystem::rename(temporary, path, error);
+}
+}  // namespace
+
+shape_cache::shape_cache(std::size_t capacity) : _capacity{std::max(capacity, 1uz)} { }
+
+auto shape_cache::global() -> shape_cache &
+{
+    static auto cache = shape_cache{};
+    return cache;
+}
+
+void shape_cache::set_directory(std::filesystem::path directory)
+{
+    auto const lock = std::scoped_lock{_mutex};
+    if (not directory.empty()) {
+        std::filesystem::create_directories(directory);
+    }
+    _directory = std::move(directory);
+}
+
+auto shape_cache::find(std::string const & key) -> std::optional<points>
+{
+    auto const lock = std::scoped_lock{_mutex};
+    auto const it = std::ranges::find(_entries, key, &entry::key);
+    if (it != _entries.end()) {
+        _entries.splice(_entries.begin(), _entries, it);
+        return it->shape;
+    }
+    if (_directory.empty()) {
+        return std::nullopt;
+    }
+    auto shape = read_file(path_of(key), key);
+    if (shape) {
+        _entries.push_front({key, *shape});
+        if (_entries.size() > _capacity) {
+            _entries.pop_back();
+        }
+    }
+    return shape;
+}
+
+void shape_cache::insert(std::string const & key, points shape)
+{
+    auto const lock = std::scoped_lock{_mutex};
+    if (not _directory.empty()) {
+        write_file(path_of(key), key, shape);
+    }
+    std::erase_if(_entries, [&key](auto const & e) { return e.key == key; });
+    _entries.push_front({key, std::move(shape)});
+    if (_entries.size() > _capacity) {
+        _entries.pop_back();
+    }
+}
+
+auto shape_cache::path_of(std::string const & key) const -> std::filesystem::path
+{
+    return _directory / fmt::format("{:016x}.shape", fnv1a(key));
+}
+
+auto shape_cache::shape_key(sym::settings const & settings) -> std::string
+{
+    auto const source = [&] {
+        if (settings.shape_file.empty()) {
+            return fmt::format("x={}\ny={}", settings.x_formula, settings.y_formula);
+        }
+        // the size and the modification time tell if the file changed
+        auto error = std::error_code{};
+        auto const size = std::filesystem::file_size(settings.shape_file, error);
+        auto const modified = std::filesystem::last_write_time(settings.shape_file, error);
+        return fmt::format(
+            "file={}\nsize={}\nmodified={}",
+            std::filesystem::absolute(settings.shape_file, error).string(), size,
+            modified.time_since_epoch().count()
+        );
+    }();
+    return fmt::format(
+        "{}\nn={}\nlength={}\nequalize={}", source, settings.number_of_points,
+        settings.total_length.numerical_value_in(ph::m), settings.equalize_distance
+    );
+}
+
+auto shape_cache::equilibrium_key(sym::settings const & settings) -> std::string
+{
+    auto const & on = settings.enabled;
+    return fmt::format(
+        "{}\nk={}\nE={}\nb={}\nc={}\nd={}\nrho={}\nforces={}{}{}{}{}", shape_key(settings),
+        settings.elastic_constant.numerical_value_in(ph::N / ph::m),
+        settings.young_modulus.numerical_value_in(ph::GPa),
+        settings.external_damping.numerical_value_in(ph::N * ph::s / ph::m),
+        settings.internal_damping.numerical_value_in(ph::N * ph::s / ph::m),
+        settings.diameter.numerical_value_in(ph::mm),
+        settings.linear_density.numerical_value_in(ph::kg / ph::m),
+        int{on.gravity}, int{on.elastic}, int{on.external_damping}, int{on.internal_damping},
+        int{on.flexural_rigidity}
+    );
+}
+
+}  // namespace sym
@@ -0,0 +1,241 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : shape_file
+ * @created     : Monday Oct 19, 2026 14:20:51 CEST
+ * @description :
+ */
+
+#include "shape_file.hpp"
+#include "scheduler.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sym
+{
+
+namespace
+{
+using point = math::vector<double, 2>;
+
+// the text is split in chunks of about this size, each parsed by a task
+constexpr auto text_chunk = std::size_t{1} << 20U;
+
+class mapped_file
+{
+    void * _memory = MAP_FAILED;
+    std::size_t _size = 0;
+
+public:
+    explicit mapped_file(std::filesystem::path const & path)
+    {
+        auto const fd = ::open(path.c_str(), O_RDONLY);  // NOLINT(*-vararg)
+        if (fd == -1) {
+            throw std::system_error{errno, std::system_category(), "open " + path.string()};
+        }
+        struct stat info{};
+        if (::fstat(fd, &info) == -1) {
+            auto const error = errno;
+            ::close(fd);
+            throw std::system_error{error, std::system_category(), "stat " + path.string()};
+        }
+        _size = static_cast<std::size_t>(info.st_size);
+        if (_size != 0) {
+            _memory = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        auto const error = errno;
+        ::close(fd);
+        if (_size != 0 and _memory == MAP_FAILED) {
+            throw std::system_error{error, std::system_category(), "mmap " + path.string()};
+        }
+        if (_size != 0) {
+            ::madvise(_memory, _size, MADV_WILLNEED);
+        }
+    }
+
+    ~mapped_file()
+    {
+        if (_memory != MAP_FAILED) {
+            ::munmap(_memory, _size);
+        }
+    }
+
+    mapped_file(mapped_file const &) = delete;
+    auto operator=(mapped_file const &) -> mapped_file & = delete;
+
+    [[nodiscard]] auto data() const noexcept { return static_cast<char const *>(_memory); }
+    [[nodiscard]] auto size() const noexcept { return _size; }
+};
+
+auto is_blank(char c) noexcept { return c == ' ' or c == '\t' or c == '\r'; }
+auto is_separator(char c) noexcept { return is_blank(c) or c == ',' or c == ';'; }
+
+/**
+ * Parses a line made of two numbers and optionally more columns.
+ * Returns false if the line is not blank and does not start with two numbers.
+ */
+auto parse_line(char const * it, char const * const end, std::vector<point> & out) -> bool
+{
+    while (it != end and is_blank(*it)) {
+        ++it;
+    }
+    if (it == end or *it == '#') {
+        return true;
+    }
+    auto x = 0.;
+    auto y = 0.;
+    auto const [x_end, x_error] = std::from_chars(it, end, x);
+    if (x_error != std::errc{} or x_end == end or not is_separator(*x_end)) {
+        return false;
+    }
+    it = x_end;
+    while (it != end and is_separator(*it)) {
+        ++it;
+    }
+    auto const [y_end, y_error] = std::from_chars(it, end, y);
+    if (y_error != std::errc{} or (y_end != end and not is_separator(*y_end))) {
+        return false;
+    }
+    out.push_back(point{x, -y});
+    return true;
+}
+
+// the results of a chunk of text: its points, or the position of the first bad line
+struct parsed_chunk
+{
+    std::vector<point> points;
+    std::optional<std::size_t> error;
+};
+
+auto parse_text(std::string_view text) -> std::expected<std::vector<point>, std::string>
+{
+    // chunk boundaries right after a newline
+    auto bounds = std::vector<std::size_t>{0};
+    for (auto pos = text_chunk; pos < text.size(); pos += text_chunk) {
+        pos = text.find('\n', std::max(pos, bounds.back()));
+        if (pos == std::string_view::npos) {
+            break;
+        }
+        bounds.push_back(++pos);
+    }
+    bounds.push_back(text.size());
+
+    auto chunks = std::vector<parsed_chunk>(bounds.size() - 1);
+    sym::scheduler::global().parallel_for(0, std::ssize(chunks), 1, [&](auto first, auto last) {
+        for (auto c = first; c < last; ++c) {
+            auto & chunk = chunks[c];
+            chunk.points.reserve((bounds[c + 1] - bounds[c]) / 16);
+            for (auto begin = bounds[c]; begin < bounds[c + 1]; ) {
+                auto const newline = text.find('\n', begin);
+                auto const end = std::min(newline, bounds[c + 1]);
+                if (not parse_line(text.data() + begin, text.data() + end, chunk.points)) {
+                    chunk.error = begin;
+                    break;
+                }
+                begin = end + 1;
+            }
+        }
+    });
+
+    auto const header_line = [&](std::size_t offset) {
+        auto const skipped = text.substr(0, offset);
+        return skipped.find_first_not_of(" \t\r\n") == std::string_view::npos;
+    };
+    if (auto & first = chunks.front(); first.error and first.points.empty() and header_line(*first.error)) {
+        // the first line is a header: parse the rest of the chunk again
+        auto const newline = text.find('\n', *first.error);
+        auto const rest = newline == std::string_view::npos ? bounds[1] : std::min(newline + 1, bounds[1]);
+        first.error.reset();
+        for (auto begin = rest; begin < bounds[1]; ) {
+            auto const end = std::min(text.find('\n', begin), bounds[1]);
+            if (not parse_line(text.data() + begin, text.data() + end, first.points)) {
+                first.error = begin;
+                break;
+            }
+            begin = end + 1;
+        }
+    }
+    for (auto const & chunk : chunks) {
+        if (chunk.error) {
+            auto const line = std::ranges::count(text.substr(0, *chunk.error), '\n') + 1;
+            auto const content = text.substr(*chunk.error, text.find('\n', *chunk.error) - *chunk.error);
+            return std::unexpected{fmt::format("line {}: expected two numbers, found '{}'", line, content)};
+        }
+    }
+
+    auto offsets = std::vector<std::size_t>(chunks.size() + 1, 0);
+    for (auto c = 0uz; c < chunks.size(); ++c) {
+        offsets[c + 1] = offsets[c] + chunks[c].points.size();
+    }
+    auto points = std::vector<point>(offsets.back());
+    sym::scheduler::global().parallel_for(0, std::ssize(chunks), 1, [&](auto first, auto last) {
+        for (auto c = first; c < last; ++c) {
+            std::ranges::copy(chunks[c].points, points.begin() + static_cast<std::ptrdiff_t>(offsets[c]));
+        }
+    });
+    return points;
+}
+
+auto parse_binary(std::span<char const> bytes) -> std::expected<std::vector<point>, std::string>
+{
+    constexpr auto point_size = 2 * sizeof(double);
+    if (bytes.size() % point_size != 0) {
+        return std::unexpected{fmt::format("{} bytes are not a whole number of f64 pairs", bytes.size())};
+    }
+    auto points = std::vector<point>(bytes.size() / point_size);
+    sym::scheduler::global().parallel_for(0, std::ssize(points), sym::parallel_grain, [&](auto first, auto last) {
+        for (auto i = first; i < last; ++i) {
+            auto xy = std::array<std::uint64_t, 2>{};
+            std::memcpy(xy.data(), bytes.data() + static_cast<std::size_t>(i) * point_size, point_size);
+            if constexpr (std::endian::native == std::endian::big) {
+                xy = {std::byteswap(xy[0]), std::byteswap(xy[1])};
+            }
+            points[i] = point{std::bit_cast<double>(xy[0]), -std::bit_cast<double>(xy[1])};
+        }
+    });
+    return points;
+}
+}  // namespace
+
+auto read_points(std::filesystem::path const & path)
+    -> std::expected<std::vector<point>, std::string>
+{
+    auto parsed = [&] -> std::expected<std::vector<point>, std::string> {
+        try {
+            auto const file = mapped_file{path};
+            auto const extension = path.extension();
+            if (extension == ".bin" or extension == ".raw") {
+                return parse_binary({file.data(), file.size()});
+            }
+            return parse_text({file.data(), file.size()});
+        } catch (std::system_error const & e) {
+            return std::unexpected{std::string{e.what()}};
+        }
+    }();
+    if (not parsed) {
+        return std::unexpected{fmt::format("{}: {}", path.string(), parsed.error())};
+    }
+    if (parsed->size() < 2) {
+        return std::unexpected{fmt::format("{}: a shape needs at least two points", path.string())};
+    }
+    if (not std::ranges::all_of(*parsed, [](auto const & p) { return std::isfinite(p[0]) and std::isfinite(p[1]); })) {
+        return std::unexpected{fmt::format("{}: the points must be finite", path.string())};
+    }
+    return parsed;
+}
+
+}  // namespace sym
@@ -6,46 +6,82 @@
  */
 
 #include "simulation.hpp"
+#include "equilibrium.hpp"
+#include "scheduler.hpp"
+#include "buffer.hpp"
+#include "allocations.hpp"
+#include "profiler.hpp"
+#include "shape_file.hpp"
+#include "shape_cache.hpp"
+#include "shape_presets.hpp"
 #include <fmt/ranges.h>
 #include <mp-units/format.h>
 #include <mp-units/ext/format.h>
 #include <mp-units/math.h>
 #include <numbers>
+#include <limits>
+#include <numeric>
+#include <deque>
+#include <optional>
+#include <stdexcept>
 #include <ranges>
 #include <expression.hpp>
+#include <jit.hpp>
+#include <evaluate.hpp>
 
 namespace sym {
 
-template <typename T>
-[[nodiscard]] constexpr
-auto radius_given_three_points(math::vector<T, 2> p1, math::vector<T, 2> p2, math::vector<T, 2> p3)
-    -> std::optional<T>
+auto segment_forces(
+    sym::settings const & settings,
+    ph::state const & first,
+    ph::state const & second
+) -> sym::segment
 {
-    // Circumrcircle formula
+    constexpr static auto zero = ph::force::zero();
+    auto const & enabled = settings.enabled;
 
-    auto const Δr12 = math::norm(p1 - p2);
-    auto const Δr23 = math::norm(p2 - p3);
-    auto const Δr13 = math::norm(p1 - p3);
+    auto const k = settings.elastic_constant;
+    auto const b = settings.external_damping;
+    auto const c = settings.internal_damping;
 
-    // Shoelace formula
-    auto const A = (
-            p1[0] * (p2[1] - p3[1]) +
-            p2[0] * (p3[1] - p1[1]) +
-            p3[0] * (p1[1] - p2[1])
-    ) / 2.;
+    auto const delta = first.x - second.x;
+    auto const length = math::norm(delta);
+    ph::direction const direction = delta / length;
+    auto const Δv = first.v - second.v;
 
-    if (A == A * 0) {
-        return std::nullopt;
-    }
+    auto const elastic = [&]() -> ph::force {
+        if (abs(length) < 0.0001 * ph::m) {
+            return zero;
+        }
+        return - k * (delta - settings.segment_length * direction);
+    };
 
-    return Δr12 * Δr23 * Δr13 / (4 * A);
+    auto const internal_damping = [&]() -> ph::force {
+        auto radial_velocity = (Δv * direction) * direction;
+        return - c * radial_velocity;
+    };
+
+    auto const external_damping = [&]() -> ph::force {
+        auto tg = decltype(direction){direction[1], -direction[0]};
+        auto tangential_velocity = (Δv * tg) * tg;
+        return - b * tangential_velocity;
+    };
+
+    return {
+        .delta = delta,
+        .length = length,
+        .direction = direction,
+        .elastic = enabled.elastic ? elastic() : zero,
+        .internal_damping = enabled.internal_damping ? internal_damping() : zero,
+        .external_damping = enabled.external_damping ? external_damping() : zero
+    };
 }
 
 auto acceleration(
     sym::settings const & settings,
     ph::state const & current,
-    ph::state const * const prev,
-    ph::state const * const next,
+    sym::segment const * const before,
+    sym::segment const * const after,
     [[maybe_unused]] ph::time const t,
     ph::metadata * metadata
 ) -> ph::acceleration
@@ -57,27 +93,19 @@ auto acceleration(
     constexpr static auto zero = ph::force::zero();
     auto const & enabled = settings.enabled;
 
-    auto const segment_length = settings.segment_length;
-    auto const k = settings.elastic_constant;
     auto const E = settings.young_modulus;
-    auto const b = settings.external_damping;
-    auto const c = settings.internal_damping;
     auto const r = settings.diameter / 2;
 
-    static auto distance = [segment_length](auto const & p, auto const & q) {
-        auto const delta = p - q;
-        auto const norm = math::norm(delta);
-        if (abs(norm) < 0.0001 * ph::m) {
-            return ph::position{0 * ph::m, 0 * ph::m};
+    // `current` is the second endpoint of `before` and the first endpoint of `after`
+    auto const pair_force = [](auto member, sym::segment const * const bfr, sym::segment const * const aft) {
+        auto result = zero;
+        if (bfr != nullptr) {
+            result -= std::invoke(member, *bfr);
         }
-        return delta - segment_length * delta * (1. / norm);
-    };
-
-    auto const elastic_force = [k](ph::state const & curr, ph::state const * const other) {
-        if (not other) {
-            return zero;
+        if (aft != nullptr) {
+            result += std::invoke(member, *aft);
         }
-        return - k * distance(curr.x, other->x);
+        return result;
     };
 
     static constexpr auto gravitational_force = [](ph::state const & curr) static {
@@ -87,92 +115,54 @@ auto acceleration(
         return ph::force{0 * ph::N, (curr.m * mp_units::si::standard_gravity).in(ph::N)};
     };
 
-    auto internal_damping = [c](ph::state const & curr, ph::state const * const other) {
-        if (not other) {
-            return zero;
-        }
-        auto Δx = curr.x - other->x;
-        auto direction = math::unit(Δx);
-        auto radial_velocity = ((curr.v - other->v) * direction) * direction;
-
-        return - c * radial_velocity;
-    };
-
-    auto external_damping = [b](ph::state const & curr, ph::state const * const other) {
-        if (not other) {
-            return zero;
-        }
-        auto Δx = curr.x - other->x;
-        auto direction = math::unit(Δx);
-        auto tg = decltype(direction){direction[1], -direction[0]};
-        auto tangential_velocity = ((curr.v - other->v) * tg) * tg;
-        return - b * tangential_velocity;
-    };
-
     /** Bending stiffness / Flexural rigidity **/
     // Second moment of area: I = ∫y²dA = π(r₁⁴ - r₀⁴) / 4 for a hollow circular cross-section
     // Bending stiffness: E·I
-    // Curvature: κ = 1 / R
     // Bending moment: M = EIκ
-    // Direction: perpendicular to the tangent
-    // >> To compute the force:
-    // Δx1 = b - a
-    // Δx2 = c - b
+    // >> Discrete curvature from the turning angle θ between the segments:
+    // t₁ = Δx1 / |Δx1|, t₂ = Δx2 / |Δx2|
+    // sin θ = t₁ × t₂, cos θ = t₁ · t₂
     // Δs = (|Δx1| + |Δx2|) / 2
-    // |F| = M / Δs
-    // t = (Δx1 + Δx2) / |Δx1 + Δx2|
-    // dir = (t[1], -t[0])
-    // F = |F| * dir
+    // κ = 2·tan(θ/2) / Δs, with tan(θ/2) = sin θ / (1 + cos θ)
+    // |F| = M / Δs · cos(θ/2)
+    // Direction: perpendicular to the bisector t₁ + t₂, whose norm is 2·cos(θ/2)
+    // F = - EI / Δs² · tan(θ/2) · (t₁ + t₂)^⊥
+    // With segments of equal length this is the same force given by the curvature of the
+    // circle through the three points
     auto bending_stiffness_force = [E,r](
-        ph::state const * const prv, ph::state const & curr, ph::state const * const nxt
+        sym::segment const * const bfr, sym::segment const * const aft
     ) -> ph::force {
-        if (not nxt or not prv) {
-            return zero;
-        }
-        auto const radius = radius_given_three_points(prv->x, curr.x, nxt->x);
-        if (not radius) {
+        if (not bfr or not aft) {
             return zero;
         }
-        auto const κ = 1. / *radius;
+        auto const & t1 = bfr->direction;
+        auto const & t2 = aft->direction;
+
+        auto const sin_θ = math::cross(t1, t2).numerical_value_in(mp_units::one);
+        auto const cos_θ = (t1 * t2).numerical_value_in(mp_units::one);
+        // a segment folded back on the previous one has sin θ = 0, so no force
+        auto const tan_half_θ = sin_θ / std::max(1 + cos_θ, 1e-12);
+
         auto const r2 = r * r;
         auto const r4 = r2 * r2;
         auto const I = std::numbers::pi * r4 / 4;  // second moment of area
-        auto const bending_moment = E * I * κ;
-
-        auto const Δx1 = prv->x - curr.x;
-        auto const Δx2 = curr.x - nxt->x;
-
-        auto const nΔx1 = math::norm(Δx1);
-        auto const nΔx2 = math::norm(Δx2);
-
-        auto const modulus = 2 * bending_moment / (nΔx1 + nΔx2);  // using the full arc length
-
-        auto const tg = math::unit(Δx1 + Δx2);  // using the weighted direction
-        auto const normal = math::vector{-tg[1], tg[0]};  // Perpendicular direction
+        auto const Δs = (bfr->length + aft->length) / 2;
 
-        // Determine the sign by checking the relative position of nxt and prv
-        auto const sign = (math::cosine(normal, Δx1) >= 0 * mp_units::one
-                       and math::cosine(normal, Δx2) >= 0 * mp_units::one)
-                         ? 1. : -1; 
+        auto const bisector = t1 + t2;
+        auto const normal = math::vector{-bisector[1], bisector[0]};
 
-        return sign * modulus * normal;
+        return - E * I / (Δs * Δs) * tan_half_θ * normal;
     };
 
-    auto const elastic = enabled.elastic
-                       ? elastic_force(current, prev) + elastic_force(current, next)
-                       : zero;
+    auto const elastic = pair_force(&sym::segment::elastic, before, after);
     auto const gravitational = enabled.gravity ? gravitational_force(current) : zero;
 
-    auto const int_damping = enabled.internal_damping
-                           ? internal_damping(current, prev) + internal_damping(current, next)
-                           : zero;
-    auto const ext_damping = enabled.external_damping
-                           ? external_damping(current, prev) + external_damping(current, next)
-                           : zero;
+    auto const int_damping = pair_force(&sym::segment::internal_damping, before, after);
+    auto const ext_damping = pair_force(&sym::segment::external_damping, before, after);
     auto const damping = int_damping + ext_damping;
 
     auto const bending_stiffness = enabled.flexural_rigidity
-                                 ? bending_stiffness_force(prev, current, next)
+                                 ? bending_stiffness_force(before, after)
                                  : zero;
     auto const total_force = elastic + gravitational + damping + bending_stiffness;
     if (metadata != nullptr) {
@@ -188,6 +178,146 @@ auto acceleration(
     return total_force * (1. / current.m);
 }
 
+void segment_pass(
+    sym::settings const & settings,
+    std::span<ph::state const> const states,
+    std::span<sym::segment> const segments,
+    std::ptrdiff_t first,
+    std::ptrdiff_t last
+)
+{
+    for (auto i = first; i < last; ++i) {
+        segments[i] = sym::segment_forces(settings, states[i], states[i + 1]);
+    }
+}
+
+void point_pass(
+    sym::settings const & settings,
+    std::span<ph::state const> const states,
+    std::span<sym::segment const> const segments,
+    std::span<ph::derivative> const out,
+    std::ptrdiff_t first,
+    std::ptrdiff_t last,
+    ph::time t,
+    std::span<ph::metadata> const metadata
+)
+{
+    auto const n_segments = std::ssize(segments);
+    for (auto i = first; i < last; ++i) {
+        auto const & current = states[i];
+        auto const * const before = i > 0 ? &segments[i - 1] : nullptr;
+        auto const * const after = i < n_segments ? &segments[i] : nullptr;
+        auto * const meta = metadata.empty() ? nullptr : &metadata[i];
+        out[i] = ph::derivative{current.v, sym::acceleration(settings, current, before, after, t, meta)};
+    }
+}
+
+void stage_states(
+    std::span<ph::state const> const states,
+    std::span<ph::derivative const> const derivatives,
+    ph::duration dt,
+    std::span<ph::state> const out
+)
+{
+    auto const advance = [dt](ph::state const & s, ph::derivative const & d) {
+        return ph::state{s.x + d.dx * dt, s.v + d.dv * dt, s.m, s.fixed};
+    };
+    std::ranges::transform(states, derivatives, out.begin(), advance);
+}
+
+void evaluate(
+    sym::settings const & settings,
+    std::span<ph::state const> const states,
+    std::span<sym::segment> const segments,
+    std::span<ph::derivative> const out,
+    ph::time t,
+    std::span<ph::metadata> const metadata
+)
+{
+    auto const profile = sym::profiler::zone{sym::profiler::zone_id::acceleration};
+    auto const n = std::ssize(states);
+    auto & pool = sym::scheduler::global();
+    pool.parallel_for(0, n - 1, sym::parallel_grain, [&](auto first, auto last) {
+        sym::segment_pass(settings, states, segments, first, last);
+    });
+    pool.parallel_for(0, n, sym::parallel_grain, [&](auto first, auto last) {
+        sym::point_pass(settings, states, segments, out, first, last, t, metadata);
+    });
+}
+
+namespace
+{
+/**
+ * The scratch buffers of RK4, kept across the steps: each chunk stays in the memory local to the
+ * worker that first touched it
+ */
+struct rk4_workspace
+{
+    sym::buffer<sym::segment> segments;
+    sym::buffer<ph::state> stage;
+    std::array<sym::buffer<ph::derivative>, 4> derivatives;
+
+    explicit rk4_workspace(std::size_t n)
+        : segments(n == 0 ? 0 : n - 1), stage(n),
+          derivatives{
+              sym::buffer<ph::derivative>(n), sym::buffer<ph::derivative>(n),
+              sym::buffer<ph::derivative>(n), sym::buffer<ph::derivative>(n)
+          }
+    {}
+};
+
+/** The scratch memory of a step, kept across the steps */
+struct step_scratch
+{
+    rk4_workspace rk4{0};
+    // of the multirate steps, assigned instead of copied so that the formulas reuse their memory
+    std::optional<sym::settings> fast;
+    std::optional<sym::settings> slow;
+    ph::simulation_data substep;
+};
+
+/**
+ * Holds the scratch memory of a step for its duration. A thread waiting for the chunks of a step
+ * runs other tasks meanwhile, which may be whole steps of another rope - the time slices of
+ * `parareal` - so each nesting level of the steps on a thread has its own.
+ */
+class step_scope
+{
+    static thread_local inline auto depth = std::size_t{0};
+    step_scratch & _scratch;
+
+    static auto at_depth(std::size_t n) -> step_scratch &
+    {
+        thread_local auto levels = std::deque<step_scratch>{};  // the references must stay valid
+        if (levels.size() <= depth) {
+            levels.emplace_back();
+        }
+        auto & scratch = levels[depth];
+        if (scratch.rk4.stage.size() != n) {
+            scratch.rk4 = rk4_workspace{n};
+        }
+        return scratch;
+    }
+
+public:
+    explicit step_scope(std::size_t n) : _scratch{at_depth(n)} { ++depth; }
+    ~step_scope() { --depth; }
+
+    step_scope(step_scope const &) = delete;
+    step_scope(step_scope &&) = delete;
+    auto operator=(step_scope const &) -> step_scope & = delete;
+    auto operator=(step_scope &&) -> step_scope & = delete;
+
+    [[nodiscard]] auto scratch() const noexcept -> step_scratch & { return _scratch; }
+};
+
+template <typename T>
+auto chunk(std::span<T> const s, std::ptrdiff_t first, std::ptrdiff_t last)
+{
+    return s.subspan(static_cast<std::size_t>(first), static_cast<std::size_t>(last - first));
+}
+}  // namespace
+
 auto integrate(
     sym::settings const & settings,
     std::span<ph::state const> const states,
@@ -196,31 +326,71 @@ auto integrate(
     bool save
 ) -> ph::simulation_data
 {
-    auto const n = std::ssize(states);
-    auto const d0 = ph::derivative{ph::velocity::zero(), ph::acceleration::zero()};
+    auto result = ph::simulation_data{};
+    sym::integrate(settings, states, t, dt, result, save);
+    return result;
+}
 
-    using meta_t = std::vector<ph::metadata>;
-    auto metadata = meta_t{};
-    if (save) {
-        metadata.resize(states.size());
+void integrate(
+    sym::settings const & settings,
+    std::span<ph::state const> const states,
+    ph::time t,
+    ph::duration dt,
+    ph::simulation_data & out,
+    bool save
+)
+{
+    if (settings.substeps > 1) {
+        sym::multirate_integrate(settings, states, t, dt, out, save);
+        return;
     }
-    auto meta_ptr = save ? std::addressof(metadata) : nullptr;
+    auto const accounting = sym::allocations::scope{sym::allocations::subsystem::simulation};
 
-    auto do_evaluate = [&settings, states, t, dt] (auto && derivatives, double time_scale, meta_t * ptr = nullptr) {
-        auto ds = std::views::all(std::forward<decltype(derivatives)>(derivatives));
-        return [&settings, states, t, dt, ds, time_scale, ptr] (auto i) {
-            return evaluate(settings, states, ds, i, t, dt * time_scale, ptr ? &(*ptr)[i] : nullptr);
-        };
+    out.state.resize(states.size());
+    out.metadata.resize(save ? states.size() : 0);
+
+    // shared by all the stages: each one fully rewrites them
+    auto const scope = step_scope{states.size()};
+    auto & workspace = scope.scratch().rk4;
+    auto const segments = std::span{workspace.segments};
+    auto const stage = std::span{workspace.stage};
+    auto const as = std::span{workspace.derivatives[0]};
+    auto const bs = std::span{workspace.derivatives[1]};
+    auto const cs = std::span{workspace.derivatives[2]};
+    auto const ds = std::span{workspace.derivatives[3]};
+
+    // the same chunks of `evaluate`, so that each worker keeps its part of the rope
+    auto & pool = sym::scheduler::global();
+    auto const n = std::ssize(states);
+    auto const stage_states = [&](std::span<ph::derivative const> derivatives, ph::duration h) {
+        pool.parallel_for(0, n, sym::parallel_grain, [&](auto first, auto last) {
+            sym::stage_states(
+                chunk(states, first, last), chunk(derivatives, first, last), h, chunk(stage, first, last)
+            );
+        });
     };
 
-    auto as = std::views::transform(std::views::iota(0, n), do_evaluate(std::views::repeat(d0), 0.))
-            | std::ranges::to<std::vector>();
-    auto bs = std::views::transform(std::views::iota(0, n), do_evaluate(as, 0.5))
-            | std::ranges::to<std::vector>();
-    auto cs = std::views::transform(std::views::iota(0, n), do_evaluate(bs, 0.5))
-            | std::ranges::to<std::vector>();
-    auto ds = std::views::transform(std::views::iota(0, n), do_evaluate(cs, 1.0, meta_ptr))
-            | std::ranges::to<std::vector>();
+    using sym::profiler::zone_id;
+    auto const profile = sym::profiler::zone{zone_id::step};
+    {
+        auto const stage_profile = sym::profiler::zone{zone_id::stage_1};
+        sym::evaluate(settings, states, segments, as, t);
+    }
+    {
+        auto const stage_profile = sym::profiler::zone{zone_id::stage_2};
+        stage_states(as, dt * 0.5);
+        sym::evaluate(settings, stage, segments, bs, t);
+    }
+    {
+        auto const stage_profile = sym::profiler::zone{zone_id::stage_3};
+        stage_states(bs, dt * 0.5);
+        sym::evaluate(settings, stage, segments, cs, t);
+    }
+    {
+        auto const stage_profile = sym::profiler::zone{zone_id::stage_4};
+        stage_states(cs, dt * 1.0);
+        sym::evaluate(settings, stage, segments, ds, t, out.metadata);
+    }
 
     auto evolve = [dt](auto && curr, auto a, auto b, auto c, auto d) {
         auto dxdt = 1./6 * (a.dx + 2 * (b.dx + c.dx) + d.dx);
@@ -229,24 +399,273 @@ auto integrate(
         return ph::state{curr.x + dxdt * dt, curr.v + dvdt * dt, curr.m, curr.fixed};
     };
 
-    return {
-        std::views::zip(states, as, bs, cs, ds)
-        | std::views::transform([&](auto && tp) { return std::apply(evolve, FWD(tp)); })
-        | std::ranges::to<std::vector<ph::state>>(),
-        std::move(metadata)
+    auto & result = out.state;
+    pool.parallel_for(0, n, sym::parallel_grain, [&](auto first, auto last) {
+        for (auto i = first; i < last; ++i) {
+            result[i] = evolve(states[i], as[i], bs[i], cs[i], ds[i]);
+        }
+    });
+}
+
+namespace
+{
+/**
+ * The enabled forces, keeping only the ones flagged (or not) as substepped
+ */
+auto split_forces(sym::settings const & settings, bool substepped) -> sym::settings::force_enabled_t
+{
+    auto enabled = settings.enabled;
+    auto const & flags = settings.substepped;
+    enabled.gravity = enabled.gravity and flags.gravity == substepped;
+    enabled.elastic = enabled.elastic and flags.elastic == substepped;
+    enabled.external_damping = enabled.external_damping and flags.external_damping == substepped;
+    enabled.internal_damping = enabled.internal_damping and flags.internal_damping == substepped;
+    enabled.flexural_rigidity = enabled.flexural_rigidity and flags.flexural_rigidity == substepped;
+    return enabled;
+}
+}  // namespace
+
+auto multirate_integrate(
+    sym::settings const & settings,
+    std::span<ph::state const> const states,
+    ph::time t,
+    ph::duration dt,
+    bool save
+) -> ph::simulation_data
+{
+    auto result = ph::simulation_data{};
+    sym::multirate_integrate(settings, states, t, dt, result, save);
+    return result;
+}
+
+void multirate_integrate(
+    sym::settings const & settings,
+    std::span<ph::state const> const states,
+    ph::time t,
+    ph::duration dt,
+    ph::simulation_data & out,
+    bool save
+)
+{
+    auto const accounting = sym::allocations::scope{sym::allocations::subsystem::simulation};
+    auto const scope = step_scope{states.size()};
+    auto & [workspace, fast_settings, slow_settings, scratch] = scope.scratch();
+    fast_settings = settings;
+    auto & fast = *fast_settings;
+    fast.enabled = split_forces(settings, true);
+    fast.substeps = 1;
+    slow_settings = settings;
+    auto & slow = *slow_settings;
+    slow.enabled = split_forces(settings, false);
+    slow.substeps = 1;
+    auto const substeps = std::max(settings.substeps, 1);
+    auto const h = dt / substeps;
+
+    // the substeps are nested steps, with their own buffers of RK4
+    auto const segments = std::span{workspace.segments};
+    auto const derivatives = std::span{workspace.derivatives[0]};
+    auto kick = [&](sym::memory::vector<ph::state> & rope, ph::time time) {
+        sym::evaluate(slow, rope, segments, derivatives, time);
+        for (auto && [s, d] : std::views::zip(rope, derivatives)) {
+            s.v += d.dv * (dt / 2);
+        }
     };
+
+    // the substeps alternate between the two buffers
+    auto & rope = out.state;
+    rope.assign(states.begin(), states.end());
+    kick(rope, t);
+    for (auto i = 0; i < substeps; ++i) {
+        sym::integrate(fast, rope, t + i * h, h, scratch);
+        std::swap(rope, scratch.state);
+    }
+    kick(rope, t + dt);
+
+    out.metadata.resize(save ? states.size() : 0);
+    if (save) {
+        sym::evaluate(settings, rope, segments, derivatives, t + dt, out.metadata);
+    }
 }
 
-auto construct_rope(
-    sym::settings const & settings, std::function<ph::vector<>(double)> const & f
-) -> std::vector<ph::state>
+auto stable_timestep(sym::settings const & settings, double safety) -> ph::duration
 {
-    auto total_length = settings.total_length.numerical_value_in(ph::m);
-    auto n_points = settings.number_of_points;
-    auto points = settings.equalize_distance
-        ? equidistant_points_along_function(f, n_points, total_length)
-        : points_along_function(f, n_points, total_length);
+    // stability boundary of RK4 along the imaginary and the negative real axes: |λ·dt| ≲ 2.78
+    constexpr auto rk4_stability_radius = 2.78;
+    // stability boundary of the kicks, explicit in the velocity: |λ·dt| ≲ 2
+    constexpr auto kick_stability_radius = 2.;
+
+    auto const m = settings.segment_mass.numerical_value_in(ph::kg);
+    auto const l = settings.segment_length.numerical_value_in(ph::m);
+    auto const k = settings.elastic_constant.numerical_value_in(ph::N / ph::m);
+    auto const E = settings.young_modulus.numerical_value_in(ph::Pa);
+    auto const b = settings.external_damping.numerical_value_in(ph::N * ph::s / ph::m);
+    auto const c = settings.internal_damping.numerical_value_in(ph::N * ph::s / ph::m);
+    auto const r = settings.diameter.numerical_value_in(ph::m) / 2;
+    auto const I = std::numbers::pi * r * r * r * r / 4;
 
+    // fastest rate (in 1/s) of the given forces
+    auto const rate = [&](sym::settings::force_enabled_t const & enabled) {
+        // a point pulled by both its neighbours in opposition feels twice the stiffness of a
+        // segment, and the chain modes reach twice that frequency: ω² ≤ 4k/m
+        auto ω2 = 0.;
+        if (enabled.elastic) {
+            ω2 += 4 * k / m;
+        }
+        // the fourth-derivative stencil of the bending reaches 16·EI / l⁴ per unit length
+        if (enabled.flexural_rigidity) {
+            ω2 += 16 * E * I / (m * l * l * l);
+        }
+        auto γ = 0.;
+        if (enabled.external_damping) {
+            γ += 4 * b / m;
+        }
+        if (enabled.internal_damping) {
+            γ += 4 * c / m;
+        }
+        return std::sqrt(ω2) + γ;
+    };
+
+    auto limit = std::numeric_limits<double>::infinity();
+    if (settings.substeps > 1) {
+        if (auto const fast = rate(split_forces(settings, true)); fast > 0.) {
+            limit = rk4_stability_radius * settings.substeps / fast;
+        }
+        if (auto const slow = rate(split_forces(settings, false)); slow > 0.) {
+            limit = std::min(limit, kick_stability_radius / slow);
+        }
+    } else if (auto const all = rate(settings.enabled); all > 0.) {
+        limit = rk4_stability_radius / all;
+    }
+
+    if (std::isinf(limit)) {
+        return settings.dt;
+    }
+    return safety * limit * ph::s;
+}
+
+auto energy(sym::settings const & settings, std::span<ph::state const> const states) -> ph::energy
+{
+    auto const l = settings.segment_length;
+    auto const k = settings.elastic_constant;
+    auto const g = 1. * mp_units::si::standard_gravity;
+
+    auto total = ph::energy::zero();
+    for (auto const & s : states) {
+        total += (s.m * math::squared_norm(s.v) / 2).in(ph::J);
+        if (settings.enabled.gravity) {
+            total -= (s.m * g * s.x[1]).in(ph::J);  // the y axis points downwards
+        }
+    }
+    if (settings.enabled.elastic) {
+        for (auto const & [a, b] : states | std::views::adjacent<2>) {
+            auto const elongation = math::norm(a.x - b.x) - l;
+            total += (k * elongation * elongation / 2).in(ph::J);
+        }
+    }
+    if (settings.enabled.flexural_rigidity) {
+        auto const r = settings.diameter / 2;
+        auto const EI = settings.young_modulus * (std::numbers::pi * r * r * r * r / 4);
+        // the bending force of `acceleration` only pulls the middle point of each pair of segments,
+        // so its energy is half the usual EI·κ²·Δs / 2, with κ = 2·tan(θ/2) / Δs
+        for (auto const & [a, b, c] : states | std::views::adjacent<3>) {
+            auto const d1 = b.x - a.x;
+            auto const d2 = c.x - b.x;
+            auto const l1 = math::norm(d1);
+            auto const l2 = math::norm(d2);
+            auto const sin_θ = (math::cross(d1, d2) / (l1 * l2)).numerical_value_in(mp_units::one);
+            auto const cos_θ = ((d1 * d2) / (l1 * l2)).numerical_value_in(mp_units::one);
+            auto const tan_half_θ = sin_θ / std::max(1 + cos_θ, 1e-12);
+            auto const Δs = (l1 + l2) / 2;
+            total += (EI * tan_half_θ * tan_half_θ / Δs).in(ph::J);
+        }
+    }
+    return total;
+}
+
+auto guarded_integrate(
+    sym::settings & settings,
+    std::span<ph::state const> const states,
+    ph::time t,
+    sym::watchdog & watchdog,
+    bool save
+) -> ph::simulation_data
+{
+    auto result = ph::simulation_data{};
+    sym::guarded_integrate(settings, states, t, watchdog, result, save);
+    return result;
+}
+
+auto guarded_integrate(
+    sym::settings & settings,
+    std::span<ph::state const> const states,
+    ph::time t,
+    sym::watchdog & watchdog,
+    ph::simulation_data & out,
+    bool save
+) -> bool
+{
+    auto const finite = [](ph::state const & s) {
+        auto const is_finite = [](auto const & q) { return std::isfinite(q.numerical_value_in(q.unit)); };
+        return std::ranges::all_of(s.x, is_finite) and std::ranges::all_of(s.v, is_finite);
+    };
+    // a time-step that is not the reduced one was set by the user, and replaces the previous one
+    if (watchdog.requested_dt != ph::duration::zero() and settings.dt != watchdog.reduced_dt) {
+        watchdog.requested_dt = ph::duration::zero();
+    }
+    // grow a reduced time-step back before the step, so that `settings.dt` is the one used
+    if (watchdog.requested_dt != ph::duration::zero() and watchdog.accepted >= watchdog.growth_steps) {
+        settings.dt = std::min(settings.dt * 2, watchdog.requested_dt);
+        watchdog.reduced_dt = settings.dt;
+        watchdog.accepted = 0;
+        if (settings.dt == watchdog.requested_dt) {
+            watchdog.requested_dt = ph::duration::zero();
+        }
+    }
+
+    // the energy of a segment swinging of its own length
+    auto const total_mass = settings.segment_mass * static_cast<double>(states.size());
+    auto const scale = (total_mass * mp_units::si::standard_gravity * settings.segment_length).in(ph::J);
+    auto const before = watchdog.energy and watchdog.energy_of == states.data()
+                      ? *watchdog.energy
+                      : sym::energy(settings, states);
+    auto const tolerance = watchdog.max_energy_growth * std::max(abs(before), scale);
+
+    auto const user_dt = watchdog.requested_dt != ph::duration::zero() ? watchdog.requested_dt : settings.dt;
+    for (auto retry = 0; retry <= watchdog.max_retries; ++retry) {
+        sym::integrate(settings, states, t, settings.dt, out, save);
+        if (std::ranges::all_of(out.state, finite)) {
+            auto const after = sym::energy(settings, out.state);
+            if (after - before <= tolerance) {
+                watchdog.energy = after;
+                watchdog.energy_of = out.state.data();  // swapped into the rope by the caller
+                ++watchdog.accepted;
+                return true;
+            }
+        }
+        ++watchdog.rollbacks;
+        settings.dt /= 2;
+        watchdog.requested_dt = user_dt;
+        watchdog.reduced_dt = settings.dt;
+        watchdog.accepted = 0;
+        fmt::print(stderr, "Unstable step at t = {}: rolling back and halving the time-step to {}\n", t, settings.dt);
+    }
+    fmt::print(stderr, "The simulation is still unstable after {} retries: the state is left unchanged\n", watchdog.max_retries);
+    // a smaller time-step did not help: give the user back their own
+    settings.dt = user_dt;
+    watchdog.requested_dt = ph::duration::zero();
+    watchdog.energy = before;
+    watchdog.energy_of = states.data();
+    out.state.assign(states.begin(), states.end());
+    out.metadata.clear();
+    return false;
+}
+
+namespace
+{
+auto states_from_points(
+    sym::settings const & settings, std::vector<math::vector<double, 2>> const & points
+) -> std::vector<ph::state>
+{
     auto at_idx = [&points](int idx) { return points.at(idx); };
     auto mkstate = [&](int idx) {
         return ph::state{
@@ -261,6 +680,155 @@ auto construct_rope(
         | std::ranges::to<std::vector>();
 }
 
+auto function_points(
+    sym::settings const & settings, std::function<ph::vector<>(double)> const & f
+) -> std::vector<math::vector<double, 2>>
+{
+    auto total_length = settings.total_length.numerical_value_in(ph::m);
+    auto n_points = settings.number_of_points;
+    auto const accounting = sym::allocations::scope{sym::allocations::subsystem::expression};
+    // the evaluations of the formulas, also counted alone by their own zone, and the geometry of the sampling
+    auto const profile = sym::profiler::zone{sym::profiler::zone_id::shape};
+    return settings.equalize_distance
+        ? equidistant_points_along_function(f, n_points, total_length)
+        : points_along_function(f, n_points, total_length);
+}
+
+// the largest distance between the curve and the polyline sampled from it, relative to the distance between the points
+constexpr auto shape_tolerance = 1e-2;
+
+// as above, but sampling the curve where it bends, so that the points follow it at any number of points
+auto function_points(
+    sym::settings const & settings, std::function<ph::vector<>(double)> const & f, curve_bound const & bound
+) -> std::vector<math::vector<double, 2>>
+{
+    if (not settings.equalize_distance) {
+        return function_points(settings, f);
+    }
+    auto const accounting = sym::allocations::scope{sym::allocations::subsystem::expression};
+    auto const profile = sym::profiler::zone{sym::profiler::zone_id::shape};
+    auto const n_points = settings.number_of_points;
+    auto const coarse = points_along_function(f, 33);
+    auto const length = std::ranges::fold_left(coarse | std::views::pairwise_transform([](auto a, auto b) {
+        return math::norm(b - a);
+    }), 0., std::plus{});
+    if (not std::isfinite(length) or length <= 0.) {
+        // not through `function_points`, which would count the zone twice
+        return equidistant_points_along_function(f, n_points, settings.total_length.numerical_value_in(ph::m));
+    }
+    auto const tolerance = shape_tolerance * length / static_cast<double>(n_points - 1);
+    return equidistant_points_along_polyline(
+        adaptive_points_along_function(f, bound, tolerance), n_points, settings.total_length.numerical_value_in(ph::m)
+    );
+}
+
+auto polyline_points(
+    sym::settings const & settings, std::span<math::vector<double, 2> const> shape
+) -> std::vector<math::vector<double, 2>>
+{
+    return equidistant_points_along_polyline(
+        shape, settings.number_of_points, settings.total_length.numerical_value_in(ph::m)
+    );
+}
+
+// the points of the initial shape, from the shape file or from the formulas
+auto initial_points(sym::settings const & settings) -> std::vector<math::vector<double, 2>>
+{
+    if (not settings.shape_file.empty()) {
+        auto const shape = sym::read_points(settings.shape_file);
+        if (not shape) {
+            throw std::runtime_error{shape.error()};
+        }
+        return polyline_points(settings, *shape);
+    }
+    if (auto const * preset = sym::find_preset(settings.x_formula, settings.y_formula)) {
+        auto const fn = [preset] (auto n) {
+            return math::vector<double, 2>{preset->x(n), -preset->y(n)};
+        };
+        auto const bound = [preset] (brun::expr::dual<brun::expr::interval> const & t) {
+            return std::array{preset->x_bound(t), -preset->y_bound(t)};
+        };
+        return function_points(settings, fn, bound);
+    }
+    auto [x_expr, y_expr] = [&] {
+        auto const accounting = sym::allocations::scope{sym::allocations::subsystem::expression};
+        return std::pair{
+            brun::expr::parse_expression(settings.x_formula, "t"),
+            brun::expr::parse_expression(settings.y_formula, "t")
+        };
+    }();
+    if (not x_expr or not y_expr) {
+        auto const & [formula, error] = not x_expr
+            ? std::pair{settings.x_formula, x_expr.error()}
+            : std::pair{settings.y_formula, y_expr.error()};
+        throw std::invalid_argument{"cannot parse '" + formula + "': " + error};
+    }
+    auto const x = brun::expr::compiled_expression{std::move(*x_expr), 't'};
+    auto const y = brun::expr::compiled_expression{std::move(*y_expr), 't'};
+    // nested in the shape sampling zone, which also counts the geometry around the evaluations
+    auto const fn = [&x, &y] (auto n) {
+        auto const profile = sym::profiler::zone{sym::profiler::zone_id::expression};
+        return math::vector<double, 2>{x(n), -y(n)};
+    };
+    auto const bound = [&x, &y] (brun::expr::dual<brun::expr::interval> const & t) {
+        auto const profile = sym::profiler::zone{sym::profiler::zone_id::expression};
+        return std::array{brun::expr::evaluate(x.tree(), 't', t), -brun::expr::evaluate(y.tree(), 't', t)};
+    };
+    return function_points(settings, fn, bound);
+}
+}  // namespace
+
+auto construct_rope(
+    sym::settings const & settings, std::function<ph::vector<>(double)> const & f
+) -> std::vector<ph::state>
+{
+    auto rope = states_from_points(settings, function_points(settings, f));
+    if (settings.start_at_equilibrium) {
+        return sym::static_equilibrium(settings, rope);
+    }
+    return rope;
+}
+
+auto construct_rope(
+    sym::settings const & settings, std::span<math::vector<double, 2> const> shape
+) -> std::vector<ph::state>
+{
+    auto rope = states_from_points(settings, polyline_points(settings, shape));
+    if (settings.start_at_equilibrium) {
+        return sym::static_equilibrium(settings, rope);
+    }
+    return rope;
+}
+
+auto initial_rope(sym::settings const & settings) -> std::vector<ph::state>
+{
+    auto & cache = sym::shape_cache::global();
+    auto const equilibrium_key = settings.start_at_equilibrium
+        ? sym::shape_cache::equilibrium_key(settings)
+        : std::string{};
+    if (settings.start_at_equilibrium) {
+        if (auto const points = cache.find(equilibrium_key)) {
+            return states_from_points(settings, *points);
+        }
+    }
+
+    auto const shape_key = sym::shape_cache::shape_key(settings);
+    auto points = cache.find(shape_key);
+    if (not points) {
+        points = initial_points(settings);
+        cache.insert(shape_key, *points);
+    }
+    auto rope = states_from_points(settings, *points);
+    if (settings.start_at_equilibrium) {
+        rope = sym::static_equilibrium(settings, rope);
+        auto const position = [](ph::state const & s) {
+            return math::vector<double, 2>{s.x[0].numerical_value_in(ph::m), s.x[1].numerical_value_in(ph::m)};
+        };
+        cache.insert(equilibrium_key, rope | std::views::transform(position) | std::ranges::to<std::vector>());
+    }
+    return rope;
+}
+
 auto points_along_function(
     std::function<ph::vector<>(double)> const & fn, ssize_t n_points,
     std::optional<double> total_len
@@ -306,8 +874,8 @@ auto equidistant_points_along_function(
     std::partial_sum(arc_lengths.begin(), arc_lengths.end(), cumulative_arc_lengths.begin() + 1);
 
     if (std::isinf(cumulative_arc_lengths.back())) {
-        fmt::print("Runtime error - infinite rope length:\n");
-        fmt::print("{}\n", cumulative_arc_lengths);
+        fmt::print(stderr, "Runtime error - infinite rope length:\n");
+        fmt::print(stderr, "{}\n", cumulative_arc_lengths);
         std::exit(1);
     }
 
@@ -339,31 +907,122 @@ auto equidistant_points_along_function(
     }
     if (std::ssize(equidistant_points) != n_points) {
         if (n_points - equidistant_points.size() > 1) {
-            fmt::print("ERROR - different number of points: : {} instead of {}\n", equidistant_points.size(), n_points);
+            fmt::print(stderr, "ERROR - different number of points: : {} instead of {}\n", equidistant_points.size(), n_points);
         }
         equidistant_points.push_back(plot_points.back());
     }
     return equidistant_points;
 }
 
+auto adaptive_points_along_function(
+    std::function<ph::vector<>(double)> const & fn, curve_bound const & bound, double tolerance,
+    int max_depth
+) -> std::vector<math::vector<double, 2>>
+{
+    using point = math::vector<double, 2>;
+    auto const segment_distance = [](point const & p, point const & a, point const & b) {
+        auto const ab = b - a;
+        auto const length2 = math::squared_norm(ab);
+        auto const s = length2 > 0 ? std::clamp((p - a) * ab / length2, 0., 1.) : 0.;
+        return math::norm(p - (a + ab * s));
+    };
+    struct piece
+    {
+        double t0, t1;
+        point p0, p1;
+        int depth;
+    };
+    auto const flat = [&](piece const & p) {
+        auto const [x, y] = bound(brun::expr::dual<brun::expr::interval>::variable({p.t0, p.t1}));
+        // the distance from the chord is convex, so it is the largest in a corner of the bounds
+        if (x.value.is_finite() and y.value.is_finite()) {
+            auto const [xs, ys] = std::pair{x.value, y.value};
+            auto const corners = std::array{point{xs.lo, ys.lo}, point{xs.lo, ys.hi}, point{xs.hi, ys.lo}, point{xs.hi, ys.hi}};
+            if (std::ranges::all_of(corners, [&](auto const & c) { return segment_distance(c, p.p0, p.p1) <= tolerance; })) {
+                return true;
+            }
+        }
+        // the curve minus the chord is zero at the ends, and its derivative is bounded by those of the
+        // curve minus the slope of the chord: over half the interval it moves at most by this much
+        auto const dx = x.derivative();
+        auto const dy = y.derivative();
+        if (not dx.is_finite() or not dy.is_finite()) {
+            return false;
+        }
+        auto const half = (p.t1 - p.t0) / 2;
+        auto const slope = (p.p1 - p.p0) / (p.t1 - p.t0);
+        auto const deviation = [](brun::expr::interval const & d, double s) {
+            return std::max(std::abs(d.lo - s), std::abs(d.hi - s));
+        };
+        return half * std::hypot(deviation(dx, slope[0]), deviation(dy, slope[1])) <= tolerance;
+    };
+
+    auto points = std::vector<point>{fn(0.)};
+    auto stack = std::vector<piece>{{0., 1., points.front(), fn(1.), 0}};
+    while (not stack.empty()) {
+        auto const p = stack.back();
+        stack.pop_back();
+        if (p.depth < max_depth and not flat(p)) {
+            auto const t = std::midpoint(p.t0, p.t1);
+            auto const middle = fn(t);
+            stack.push_back({t, p.t1, middle, p.p1, p.depth + 1});
+            stack.push_back({p.t0, t, p.p0, middle, p.depth + 1});
+        } else {
+            points.push_back(p.p1);
+        }
+    }
+    return points;
+}
+
+auto equidistant_points_along_polyline(
+    std::span<math::vector<double, 2> const> shape, ssize_t n_points,
+    std::optional<double> total_len
+) -> std::vector<math::vector<double, 2>>
+{
+    auto const accounting = sym::allocations::scope{sym::allocations::subsystem::expression};
+    auto & pool = sym::scheduler::global();
+    auto const m = std::ssize(shape);
+
+    // arc length at each vertex
+    auto cumulative = std::vector<double>(shape.size(), 0.);
+    pool.parallel_for(1, m, sym::parallel_grain, [&](auto first, auto last) {
+        for (auto i = first; i < last; ++i) {
+            cumulative[i] = math::norm(shape[i] - shape[i - 1]);
+        }
+    });
+    std::partial_sum(cumulative.begin(), cumulative.end(), cumulative.begin());
+    auto const length = cumulative.back();
+    if (not (length > 0.) or std::isinf(length)) {
+        throw std::invalid_argument{"the polyline must have a finite, non-zero length"};
+    }
+
+    auto const ratio = total_len.value_or(length) / length;
+    auto const Δl = length / static_cast<double>(n_points - 1);
+    auto points = std::vector<math::vector<double, 2>>(static_cast<std::size_t>(n_points));
+    pool.parallel_for(0, n_points, sym::parallel_grain, [&](auto first, auto last) {
+        for (auto j = first; j < last; ++j) {
+            auto const arc = std::min(static_cast<double>(j) * Δl, length);
+            // the segment [i, i + 1] containing the arc, skipping the degenerate ones
+            auto const i = std::clamp<std::ptrdiff_t>(
+                std::ranges::upper_bound(cumulative, arc) - cumulative.begin() - 1, 0, m - 2
+            );
+            auto const span = cumulative[i + 1] - cumulative[i];
+            auto const fraction = span > 0. ? (arc - cumulative[i]) / span : 0.;
+            points[j] = (shape[i] + (shape[i + 1] - shape[i]) * fraction) * ratio;
+        }
+    });
+    points.back() = shape.back() * ratio;
+    return points;
+}
 
 void reset(
     sym::settings & settings,
-    std::vector<ph::state> & rope, std::vector<ph::metadata> & metadata,
+    sym::memory::vector<ph::state> & rope, sym::memory::vector<ph::metadata> & metadata,
     ph::duration & t
 )
 {
-    using maybe_expression = std::expected<brun::expr::expression, std::string>;
-    auto eval = [](auto & arr) -> maybe_expression {
-        auto ptr = arr.data();
-        return brun::expr::parse_expression(std::string_view{ptr, std::strlen(ptr)}, "t");
-    };
-    auto x_expr = eval(settings.x_formula);
-    auto y_expr = eval(settings.y_formula);
-    auto const fn = [x=(x_expr.value())['t'],y=(y_expr.value())['t']] (auto n) {
-        return math::vector<double, 2>{x(n), -y(n)};
-    };
-    rope = sym::construct_rope(settings, fn);
+    auto const initial = sym::initial_rope(settings);
+    rope.assign(initial.begin(), initial.end());
     metadata.clear();
     t = settings.t0;
 }
@@ -375,13 +1034,18 @@ void dump_settings(sym::settings const & settings) noexcept {
         n, k, E, b, c,
         total_length, diameter, segment_length, linear_density, segment_mass,
         t0, t1, dt, fps,
-        x_formula, y_formula, equalize_distance,
-        enabled
+        x_formula, y_formula, equalize_distance, start_at_equilibrium, shape_file,
+        enabled, substeps, substepped
     ] = settings;
     auto const g = (1. * mp_units::si::standard_gravity).in(ph::N / ph::kg);
     fmt::print("Number of points (n):             {}\n", n);
-    fmt::print("Starting formulas:                x(t) = {}\n", x_formula);
-    fmt::print("                                  y(t) = {}\n", y_formula);
+    if (shape_file.empty()) {
+        fmt::print("Starting formulas:                x(t) = {}\n", x_formula);
+        fmt::print("                                  y(t) = {}\n", y_formula);
+    } else {
+        fmt::print("Starting shape file:              {}\n", shape_file);
+    }
+    fmt::print("Start at static equilibrium:      {}\n", start_at_equilibrium);
     fmt::print("Elastic constant (k):             {}\n", k);
     fmt::print("Young modulus (E):                {}\n", E);
     fmt::print("External damping coefficient (b): {}\n", b);
@@ -398,6 +1062,7 @@ void dump_settings(sym::settings const & settings) noexcept {
     fmt::print("Initial time point:               {}\n", t0);
     fmt::print("Final time point:                 {}\n", t1);
     fmt::print("Simulation time-step:             {}\n", dt);
+    fmt::print("Stable time-step (estimate):      {}\n", sym::stable_timestep(settings));
     fmt::print("Frames per second:                {}\n", fps);
     fmt::print("Steps per frame:                  {}\n", dt * fps);
     fmt::print("\n");
@@ -408,4 +1073,14 @@ void dump_settings(sym::settings const & settings) noexcept {
     fmt::print("External damping:                 {}\n", enabled.external_damping);
     fmt::print("Flexural rigidity:                {}\n", enabled.flexural_rigidity);
     fmt::print("\n");
+    fmt::print("Substeps per time-step:           {}\n", substeps);
+    if (substeps > 1) {
+        fmt::print("Substepped forces:\n");
+        fmt::print("Gravity:                          {}\n", substepped.gravity);
+        fmt::print("Elastic:                          {}\n", substepped.elastic);
+        fmt::print("Internal damping:                 {}\n", substepped.internal_damping);
+        fmt::print("External damping:                 {}\n", substepped.external_damping);
+        fmt::print("Flexural rigidity:                {}\n", substepped.flexural_rigidity);
+    }
+    fmt::print("\n");
 }
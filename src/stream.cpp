@@ -0,0 +1,199 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : stream
+ * @created     : Sunday Oct 18, 2026 12:31:06 CEST
+ * @description : 
+ */
+
+#include "stream.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <ranges>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace sym
+{
+
+namespace
+{
+// written when the buffer grows past this size
+constexpr auto chunk_size = std::size_t{1} << 20U;
+
+constexpr auto binary_magic = std::uint32_t{0x46504F52};  // "ROPF" in little endian
+constexpr auto binary_version = std::uint16_t{1};
+
+template <typename T>
+void append_le(fmt::memory_buffer & buffer, T value)
+{
+    using bits_t = std::conditional_t<sizeof(T) == 8, std::uint64_t,
+                   std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint16_t>>;
+    auto bits = std::bit_cast<bits_t>(value);
+    if constexpr (std::endian::native == std::endian::big) {
+        bits = std::byteswap(bits);
+    }
+    auto const bytes = std::bit_cast<std::array<char, sizeof(T)>>(bits);
+    buffer.append(bytes.data(), bytes.data() + bytes.size());
+}
+
+// the components of each field, with their NDJSON names
+struct component
+{
+    std::uint16_t field;
+    char const * name;
+    std::size_t index;  // 0 for x, 1 for y
+};
+
+constexpr auto components = std::array{
+    component{stream_emitter::position, "x", 0}, component{stream_emitter::position, "y", 1},
+    component{stream_emitter::velocity, "vx", 0}, component{stream_emitter::velocity, "vy", 1},
+    component{stream_emitter::force, "fx", 0}, component{stream_emitter::force, "fy", 1}
+};
+
+auto value_of(
+    component const & c, ph::state const & s, ph::metadata const * m
+) noexcept -> double
+{
+    switch (c.field) {
+    case stream_emitter::position:
+        return s.x[c.index].numerical_value_in(ph::m);
+    case stream_emitter::velocity:
+        return s.v[c.index].numerical_value_in(ph::m / ph::s);
+    default:
+        return m == nullptr ? 0. : m->total[c.index].numerical_value_in(ph::N);
+    }
+}
+}  // namespace
+
+stream_emitter::stream_emitter(std::string const & path, options opts)
+    : _fd{STDOUT_FILENO}, _owned{path != "-"}, _options{opts}
+{
+    _options.every = std::max(_options.every, 1);
+    if (_owned) {
+        _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);  // NOLINT(*-vararg)
+        if (_fd == -1) {
+            throw std::system_error{errno, std::system_category(), "open " + path};
+        }
+    }
+    _buffer.reserve(2 * chunk_size);
+}
+
+stream_emitter::~stream_emitter()
+{
+    try {
+        flush();
+    } catch (std::system_error const &) {  // NOLINT(*-empty-catch)
+        // the reader went away: nothing left to do
+    }
+    if (_owned) {
+        ::close(_fd);
+    }
+}
+
+void stream_emitter::step(
+    ph::time t, std::span<ph::state const> rope, std::span<ph::metadata const> metadata
+)
+{
+    if (_steps++ % _options.every != 0) {
+        return;
+    }
+    emit(t, rope, metadata);
+    if (_buffer.size() >= chunk_size) {
+        flush();
+    }
+}
+
+void stream_emitter::emit(
+    ph::time t, std::span<ph::state const> rope, std::span<ph::metadata const> metadata
+)
+{
+    auto storage = std::array<component, components.size()>{};
+    auto const selected = std::span{storage.begin(), std::ranges::copy_if(components, storage.begin(), [this](auto const & c) {
+        return (_options.fields & c.field) != 0;
+    }).out};
+    auto const meta = [&](std::size_t i) { return i < metadata.size() ? &metadata[i] : nullptr; };
+    auto const time = t.numerical_value_in(ph::s);
+
+    if (_options.fmt == format::binary) {
+        append_le(_buffer, binary_magic);
+        append_le(_buffer, binary_version);
+        append_le(_buffer, _options.fields);
+        append_le(_buffer, static_cast<std::uint32_t>(rope.size()));
+        append_le(_buffer, std::uint32_t{0});
+        append_le(_buffer, time);
+        for (auto i = 0uz; i < rope.size(); ++i) {
+            for (auto const & c : selected) {
+                append_le(_buffer, value_of(c, rope[i], meta(i)));
+            }
+        }
+        return;
+    }
+
+    auto out = std::back_inserter(_buffer);
+    fmt::format_to(out, R"({{"t":{})", time);
+    for (auto const & c : selected) {
+        fmt::format_to(out, R"(,"{}":[)", c.name);
+        for (auto i = 0uz; i < rope.size(); ++i) {
+            fmt::format_to(out, "{}{}", i == 0 ? "" : ",", value_of(c, rope[i], meta(i)));
+        }
+        _buffer.push_back(']');
+    }
+    _buffer.append(std::string_view{"}\n"});
+}
+
+void stream_emitter::flush()
+{
+    auto const * data = _buffer.data();
+    auto left = _buffer.size();
+    while (left > 0) {
+        auto const written = ::write(_fd, data, left);
+        if (written == -1) {
+            auto const error = errno;
+            if (error == EINTR) {
+                continue;
+            }
+            _buffer.clear();
+            throw std::system_error{error, std::system_category(), "stream write"};
+        }
+        data += written;
+        left -= static_cast<std::size_t>(written);
+    }
+    _buffer.clear();
+}
+
+auto parse_stream_format(std::string_view name) -> std::expected<stream_emitter::format, std::string>
+{
+    if (name == "ndjson") {
+        return stream_emitter::format::ndjson;
+    }
+    if (name == "binary") {
+        return stream_emitter::format::binary;
+    }
+    return std::unexpected{fmt::format("unknown stream format '{}': use ndjson or binary", name)};
+}
+
+auto parse_stream_fields(std::string_view names) -> std::expected<std::uint16_t, std::string>
+{
+    constexpr auto known = std::array{
+        std::pair{std::string_view{"position"}, stream_emitter::position},
+        std::pair{std::string_view{"velocity"}, stream_emitter::velocity},
+        std::pair{std::string_view{"force"}, stream_emitter::force}
+    };
+    auto fields = std::uint16_t{0};
+    for (auto const name : names | std::views::split(',')) {
+        auto const field = std::string_view{name};
+        auto const it = std::ranges::find(known, field, &decltype(known)::value_type::first);
+        if (it == known.end()) {
+            return std::unexpected{fmt::format("unknown stream field '{}': use position, velocity or force", field)};
+        }
+        fields = static_cast<std::uint16_t>(fields | it->second);
+    }
+    return fields;
+}
+
+}  // namespace sym
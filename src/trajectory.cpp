@@ -0,0 +1,383 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : trajectory
+ * @created     : Monday Oct 19, 2026 09:52:40 CEST
+ * @description :
+ */
+
+#include "trajectory.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace sym
+{
+
+namespace
+{
+constexpr auto file_magic = std::uint32_t{0x54504F52};  // "ROPT" in little endian
+constexpr auto file_version = std::uint16_t{1};
+constexpr auto file_header_size = 32uz;
+constexpr auto frame_header_size = 24uz;
+
+// rANS with a 32 bits state, byte-wise renormalization and 12 bits frequencies
+constexpr auto scale_bits = 12U;
+constexpr auto scale = std::uint32_t{1} << scale_bits;
+constexpr auto rans_lower = std::uint32_t{1} << 23U;
+
+template <typename T>
+void append_le(std::vector<std::uint8_t> & out, T value)
+{
+    using bits_t = std::conditional_t<sizeof(T) == 8, std::uint64_t,
+                   std::conditional_t<sizeof(T) == 4, std::uint32_t,
+                   std::conditional_t<sizeof(T) == 2, std::uint16_t, std::uint8_t>>>;
+    auto bits = std::bit_cast<bits_t>(value);
+    if constexpr (std::endian::native == std::endian::big) {
+        bits = std::byteswap(bits);
+    }
+    auto const bytes = std::bit_cast<std::array<std::uint8_t, sizeof(T)>>(bits);
+    out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+template <typename T>
+auto read_le(std::uint8_t const * in) noexcept -> T
+{
+    using bits_t = std::conditional_t<sizeof(T) == 8, std::uint64_t,
+                   std::conditional_t<sizeof(T) == 4, std::uint32_t,
+                   std::conditional_t<sizeof(T) == 2, std::uint16_t, std::uint8_t>>>;
+    auto bits = bits_t{};
+    std::memcpy(&bits, in, sizeof(bits));
+    if constexpr (std::endian::native == std::endian::big) {
+        bits = std::byteswap(bits);
+    }
+    return std::bit_cast<T>(bits);
+}
+
+[[noreturn]] void corrupted()
+{
+    throw std::runtime_error{"corrupted trajectory frame"};
+}
+
+auto quantize(ph::length x, double step) noexcept -> std::int64_t
+{
+    // keeps the residuals far from overflowing even if the rope blows up
+    constexpr auto limit = 0x1p52;
+    auto const q = x.numerical_value_in(ph::m) / step;
+    return std::isfinite(q) ? std::llround(std::clamp(q, -limit, limit)) : 0;
+}
+
+void append_varint(std::vector<std::uint8_t> & out, std::int64_t value)
+{
+    auto zigzag = (static_cast<std::uint64_t>(value) << 1U) ^ static_cast<std::uint64_t>(value >> 63);
+    while (zigzag >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(zigzag | 0x80U));
+        zigzag >>= 7U;
+    }
+    out.push_back(static_cast<std::uint8_t>(zigzag));
+}
+
+auto read_varint(std::uint8_t const *& in, std::uint8_t const * end) -> std::int64_t
+{
+    auto zigzag = std::uint64_t{0};
+    for (auto shift = 0U; ; shift += 7) {
+        if (in == end or shift > 63) {
+            corrupted();
+        }
+        auto const byte = *in++;
+        zigzag |= static_cast<std::uint64_t>(byte & 0x7FU) << shift;
+        if ((byte & 0x80U) == 0) {
+            break;
+        }
+    }
+    return static_cast<std::int64_t>(zigzag >> 1U) ^ -static_cast<std::int64_t>(zigzag & 1U);
+}
+
+// scales the byte counts to frequencies summing to `scale`, keeping every present byte
+auto normalize(std::array<std::uint32_t, 256> const & counts, std::size_t total) -> std::array<std::uint32_t, 256>
+{
+    auto freqs = std::array<std::uint32_t, 256>{};
+    auto sum = std::uint32_t{0};
+    for (auto s = 0uz; s < counts.size(); ++s) {
+        if (counts[s] != 0) {
+            freqs[s] = std::max(1U, static_cast<std::uint32_t>(std::uint64_t{counts[s]} * scale / total));
+            sum += freqs[s];
+        }
+    }
+    while (sum > scale) {
+        --*std::ranges::max_element(freqs);
+        --sum;
+    }
+    *std::ranges::max_element(freqs) += scale - sum;
+    return freqs;
+}
+
+/*
+ * Payload: u32 number of bytes, u16 number of distinct bytes, the (u8 byte, u16 frequency)
+ * table, and the rANS stream, which starts with the final state of the encoder.
+ */
+void encode_bytes(std::vector<std::uint8_t> const & bytes, std::vector<std::uint8_t> & out)
+{
+    out.clear();
+    append_le(out, static_cast<std::uint32_t>(bytes.size()));
+    if (bytes.empty()) {
+        return;
+    }
+
+    auto counts = std::array<std::uint32_t, 256>{};
+    for (auto const b : bytes) {
+        ++counts[b];
+    }
+    auto const freqs = normalize(counts, bytes.size());
+    auto cumulative = std::array<std::uint32_t, 256>{};
+    auto symbols = std::uint16_t{0};
+    for (auto s = 0U, sum = 0U; s < 256; ++s) {
+        cumulative[s] = sum;
+        sum += freqs[s];
+        symbols += freqs[s] != 0 ? 1 : 0;
+    }
+    append_le(out, symbols);
+    for (auto s = 0U; s < 256; ++s) {
+        if (freqs[s] != 0) {
+            append_le(out, static_cast<std::uint8_t>(s));
+            append_le(out, static_cast<std::uint16_t>(freqs[s]));
+        }
+    }
+
+    // the encoder runs backwards, so that the decoder reads forwards
+    auto const table_end = out.size();
+    auto x = rans_lower;
+    for (auto const b : bytes | std::views::reverse) {
+        auto const f = freqs[b];
+        auto const x_max = ((rans_lower >> scale_bits) << 8U) * f;
+        while (x >= x_max) {
+            out.push_back(static_cast<std::uint8_t>(x & 0xFFU));
+            x >>= 8U;
+        }
+        x = ((x / f) << scale_bits) + (x % f) + cumulative[b];
+    }
+    for (auto i = 0U; i < 4; ++i) {
+        out.push_back(static_cast<std::uint8_t>(x & 0xFFU));
+        x >>= 8U;
+    }
+    std::reverse(out.begin() + static_cast<std::ptrdiff_t>(table_end), out.end());
+}
+
+void decode_bytes(std::span<std::uint8_t const> payload, std::vector<std::uint8_t> & bytes)
+{
+    auto const * in = payload.data();
+    auto const * const end = in + payload.size();
+    if (payload.size() < 4) {
+        corrupted();
+    }
+    bytes.resize(read_le<std::uint32_t>(in));
+    in += 4;
+    if (bytes.empty()) {
+        return;
+    }
+
+    if (end - in < 2) {
+        corrupted();
+    }
+    auto const symbols = read_le<std::uint16_t>(in);
+    in += 2;
+    if (symbols == 0 or symbols > 256 or end - in < 3 * symbols + 4) {
+        corrupted();
+    }
+    auto freqs = std::array<std::uint32_t, 256>{};
+    auto cumulative = std::array<std::uint32_t, 256>{};
+    auto lookup = std::array<std::uint8_t, scale>{};
+    auto sum = std::uint32_t{0};
+    for (auto i = 0U; i < symbols; ++i, in += 3) {
+        auto const s = in[0];
+        auto const f = std::uint32_t{read_le<std::uint16_t>(in + 1)};
+        if (f == 0 or sum + f > scale) {
+            corrupted();
+        }
+        freqs[s] = f;
+        cumulative[s] = sum;
+        std::fill_n(lookup.begin() + sum, f, s);
+        sum += f;
+    }
+    if (sum != scale) {
+        corrupted();
+    }
+
+    auto x = std::uint32_t{in[0]} << 24U | std::uint32_t{in[1]} << 16U | std::uint32_t{in[2]} << 8U | in[3];
+    in += 4;
+    for (auto & b : bytes) {
+        auto const slot = x & (scale - 1);
+        auto const s = lookup[slot];
+        b = s;
+        x = freqs[s] * (x >> scale_bits) + slot - cumulative[s];
+        while (x < rans_lower) {
+            if (in == end) {
+                corrupted();
+            }
+            x = (x << 8U) | *in++;
+        }
+    }
+}
+}  // namespace
+
+trajectory_writer::trajectory_writer(std::filesystem::path const & path, trajectory_options opts)
+    : _file{path, std::ios::binary | std::ios::trunc},
+      _path{path},
+      _step{2 * opts.error_bound.numerical_value_in(ph::m)},
+      _keyframe_interval{std::max(opts.keyframe_interval, 1)}
+{
+    if (not (_step > 0.)) {
+        throw std::invalid_argument{"the error bound of a trajectory must be positive"};
+    }
+    if (not _file) {
+        throw std::system_error{errno, std::system_category(), "open " + path.string()};
+    }
+    auto header = std::vector<std::uint8_t>{};
+    append_le(header, file_magic);
+    append_le(header, file_version);
+    append_le(header, std::uint16_t{0});
+    append_le(header, static_cast<std::uint32_t>(_keyframe_interval));
+    append_le(header, std::uint32_t{0});
+    append_le(header, _step);
+    append_le(header, std::uint64_t{0});
+    _file.write(reinterpret_cast<char const *>(header.data()), static_cast<std::streamsize>(header.size()));
+}
+
+void trajectory_writer::record(ph::time t, std::span<ph::state const> rope)
+{
+    _current.resize(2 * rope.size());
+    for (auto i = 0uz; i < rope.size(); ++i) {
+        _current[2 * i] = quantize(rope[i].x[0], _step);
+        _current[2 * i + 1] = quantize(rope[i].x[1], _step);
+    }
+    auto const keyframe = _frames % static_cast<std::size_t>(_keyframe_interval) == 0 or _previous.size() != _current.size();
+
+    // x and y residuals are interleaved, each relative to the same coordinate of the previous point
+    _residuals.clear();
+    auto last = std::array<std::int64_t, 2>{};
+    for (auto k = 0uz; k < _current.size(); ++k) {
+        auto const value = keyframe ? _current[k] : _current[k] - _previous[k];
+        append_varint(_residuals, value - std::exchange(last[k % 2], value));
+    }
+    encode_bytes(_residuals, _payload);
+
+    auto header = std::vector<std::uint8_t>{};
+    header.reserve(frame_header_size);
+    append_le(header, static_cast<std::uint32_t>(_payload.size()));
+    append_le(header, static_cast<std::uint32_t>(rope.size()));
+    append_le(header, t.numerical_value_in(ph::s));
+    append_le(header, std::uint8_t{keyframe});
+    header.resize(frame_header_size);
+    _file.write(reinterpret_cast<char const *>(header.data()), static_cast<std::streamsize>(header.size()));
+    _file.write(reinterpret_cast<char const *>(_payload.data()), static_cast<std::streamsize>(_payload.size()));
+    if (not _file) {
+        throw std::system_error{errno, std::system_category(), "write " + _path.string()};
+    }
+
+    std::swap(_previous, _current);
+    ++_frames;
+    _raw_bytes += rope.size() * 2 * sizeof(double);
+    _compressed_bytes += frame_header_size + _payload.size();
+}
+
+void trajectory_writer::flush()
+{
+    if (not _file.flush()) {
+        throw std::system_error{errno, std::system_category(), "write " + _path.string()};
+    }
+}
+
+trajectory_reader::trajectory_reader(std::filesystem::path const & path)
+{
+    auto file = std::ifstream{path, std::ios::binary};
+    if (not file) {
+        throw std::runtime_error{"cannot open " + path.string()};
+    }
+    _data.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+
+    auto const * const data = _data.data();
+    if (_data.size() < file_header_size or read_le<std::uint32_t>(data) != file_magic) {
+        throw std::runtime_error{path.string() + " is not a trajectory file"};
+    }
+    if (read_le<std::uint16_t>(data + 4) != file_version) {
+        throw std::runtime_error{path.string() + ": unsupported trajectory version"};
+    }
+    _step = read_le<double>(data + 16);
+
+    for (auto offset = file_header_size; offset + frame_header_size <= _data.size(); ) {
+        auto const * const header = data + offset;
+        auto const info = frame_info{
+            .offset = offset + frame_header_size,
+            .bytes = read_le<std::uint32_t>(header),
+            .points = read_le<std::uint32_t>(header + 4),
+            .time = read_le<double>(header + 8),
+            .keyframe = header[16] != 0,
+        };
+        if (info.offset + info.bytes > _data.size()) {
+            break;  // truncated by an interrupted recording
+        }
+        if (_frames.empty() ? not info.keyframe : not info.keyframe and info.points != _frames.back().points) {
+            throw std::runtime_error{path.string() + ": inconsistent trajectory frames"};
+        }
+        _frames.push_back(info);
+        offset = info.offset + info.bytes;
+    }
+}
+
+auto trajectory_reader::time(std::size_t frame) const -> ph::time
+{
+    return _frames.at(frame).time * ph::s;
+}
+
+auto trajectory_reader::positions(std::size_t frame) -> std::span<ph::position const>
+{
+    if (frame >= _frames.size()) {
+        throw std::out_of_range{"trajectory frame out of range"};
+    }
+    if (frame != _decoded) {
+        auto first = frame;
+        while (not _frames[first].keyframe) {
+            --first;
+        }
+        if (_decoded != static_cast<std::size_t>(-1) and _decoded >= first and _decoded < frame) {
+            first = _decoded + 1;
+        }
+        for (auto i = first; i <= frame; ++i) {
+            decode(i);
+        }
+        _positions.resize(_frames[frame].points);
+        for (auto i = 0uz; i < _positions.size(); ++i) {
+            _positions[i] = ph::position{
+                static_cast<double>(_quantized[2 * i]) * _step * ph::m,
+                static_cast<double>(_quantized[2 * i + 1]) * _step * ph::m
+            };
+        }
+    }
+    return _positions;
+}
+
+void trajectory_reader::decode(std::size_t frame)
+{
+    auto const & info = _frames[frame];
+    _decoded = static_cast<std::size_t>(-1);  // until the frame is complete
+    decode_bytes({_data.data() + info.offset, info.bytes}, _residuals);
+
+    _quantized.resize(2 * std::size_t{info.points});
+    auto const * in = _residuals.data();
+    auto const * const end = in + _residuals.size();
+    auto last = std::array<std::int64_t, 2>{};
+    for (auto k = 0uz; k < _quantized.size(); ++k) {
+        auto const value = last[k % 2] += read_varint(in, end);
+        _quantized[k] = info.keyframe ? value : _quantized[k] + value;
+    }
+    _decoded = frame;
+}
+
+}  // namespace sym
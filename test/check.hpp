@@ -0,0 +1,43 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : check
+ * @created     : Saturday Oct 24, 2026 16:31:52 CEST
+ * @description : the checks of the tests, counting the failures
+ * */
+
+#ifndef TEST_CHECK_HPP
+#define TEST_CHECK_HPP
+
+#include <fmt/format.h>
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+namespace test
+{
+
+inline auto failures = 0;
+
+inline void check(bool ok, std::string_view what)
+{
+    if (not ok) {
+        fmt::print(stderr, "{}\n", what);
+        ++failures;
+    }
+}
+
+/** The tolerance is relative to the expected value, and absolute below 1 */
+inline void check(double actual, double expected, double tolerance, std::string_view what)
+{
+    if (not (std::abs(actual - expected) <= tolerance * std::max(std::abs(expected), 1.))) {
+        fmt::print(stderr, "{}: {} instead of {}\n", what, actual, expected);
+        ++failures;
+    }
+}
+
+/** The exit status of the test */
+inline auto result() -> int { return failures == 0 ? 0 : 1; }
+
+}  // namespace test
+
+#endif /* TEST_CHECK_HPP */
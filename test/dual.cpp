@@ -0,0 +1,75 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : dual
+ * @created     : Saturday Oct 24, 2026 14:32:09 CEST
+ * @description : the derivatives of the expressions on duals, scalar and batched
+ */
+
+#include "check.hpp"
+#include <expression.hpp>
+#include <evaluate.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace
+{
+auto close(double a, double b) -> bool
+{
+    return std::abs(a - b) <= 1e-12 * std::max({std::abs(a), std::abs(b), 1.}) or (std::isnan(a) and std::isnan(b));
+}
+
+using test::check;
+}  // namespace
+
+int main()
+{
+    using brun::expr::batch;
+    using brun::expr::dual;
+
+    // every lane of a dual on batches must be the dual of its value
+    auto const formulas = std::vector<std::string>{
+        "x^2 - 3x + 1",
+        "sin(x) * cos(2x) + exp(-x^2)",
+        "atan(x)^2 + sqrt(abs(x) + 1) - cbrt(x + 10)",
+        "ln(x^2 + 1) / (1 + x^2)",
+        "tan(x / 2) + asin(x / 4) * acos(x / 4)",
+        "x^x^0.5 + 2^x - (x + 5)^-1",
+        "(x % 2) * x",
+    };
+    for (auto const & formula : formulas) {
+        auto const expr = brun::expr::expression{formula, "x"};
+        for (auto first = 0.; first < 3.; first += 0.125 * batch::size()) {
+            auto const values = batch{[&](auto i) { return first + 0.125 * static_cast<double>(i); }};
+            auto const lanes = brun::expr::evaluate(expr, 'x', dual<batch>::variable(values));
+            for (auto i = 0uz; i < batch::size(); ++i) {
+                auto const scalar = brun::expr::evaluate(expr, 'x', dual<>::variable(values[i]));
+                auto const where = formula + " at " + std::to_string(values[i]);
+                check(close(lanes.value[i], scalar.value), where + ": value " + std::to_string(lanes.value[i])
+                    + " instead of " + std::to_string(scalar.value));
+                check(close(lanes.derivative()[i], scalar.derivative()), where + ": derivative "
+                    + std::to_string(lanes.derivative()[i]) + " instead of " + std::to_string(scalar.derivative()));
+            }
+        }
+    }
+
+    // f = k x² + sin(k y) - y / x
+    auto const f = brun::expr::expression{"k*x^2 + sin(k*y) - y/x", "kxy"};
+    for (auto const & [k, x, y] : std::vector<std::array<double, 3>>{{2., 3., 0.5}, {-1.5, 0.25, 4.}, {0.1, -2., -3.}}) {
+        auto const [value, slopes] = brun::expr::gradient(f, std::array{'k', 'x', 'y'}, std::array{k, x, y});
+        auto const where = "gradient at (" + std::to_string(k) + ", " + std::to_string(x) + ", " + std::to_string(y) + ")";
+        check(close(value, k * x * x + std::sin(k * y) - y / x), where + ": value");
+        check(close(slopes[0], x * x + y * std::cos(k * y)), where + ": d/dk");
+        check(close(slopes[1], 2 * k * x + y / (x * x)), where + ": d/dx");
+        check(close(slopes[2], k * std::cos(k * y) - 1 / x), where + ": d/dy");
+    }
+
+    // the parameters in a different order than in the expression
+    auto const g = brun::expr::expression{"k*x^2", "kx"};
+    auto const [value, slopes] = brun::expr::gradient(g, std::array{'x', 'k'}, std::array{3., 2.});
+    check(value == 18. and slopes[0] == 12. and slopes[1] == 9., "gradient of k*x^2 at x = 3, k = 2");
+
+    return test::result();
+}
@@ -6,6 +6,13 @@
  */
 
 #include <expression.hpp>
+#include <jit.hpp>
+#include <evaluate.hpp>
+#include <interval.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 
 int main(int argc, char * argv[])
@@ -15,5 +22,36 @@ int main(int argc, char * argv[])
         return 1;
     }
     auto expr = brun::expr::expression(argv[1], argv[2]);
-    std::cout << expr.eval(brun::expr::parameter{*argv[2], std::stod(argv[3])});
+    auto const value = std::stod(argv[3]);
+    auto const interpreted = expr.eval(brun::expr::parameter{*argv[2], value});
+    std::cout << interpreted;
+
+    // the interval evaluation must enclose the values sampled around the given one
+    auto const around = brun::expr::interval{value - 0.5, value + 0.5};
+    auto const enclosure = brun::expr::evaluate(expr, *argv[2], around);
+    for (auto i = 0; i <= 1000; ++i) {
+        auto const x = std::min(around.lo + around.width() * i / 1000, around.hi);
+        auto const sampled = expr.eval(brun::expr::parameter{*argv[2], x});
+        if (not std::isnan(sampled) and not enclosure.contains(sampled)) {
+            std::cerr << "\ninterval: [" << enclosure.lo << ", " << enclosure.hi << "] does not contain "
+                      << sampled << " at " << x << '\n';
+            return 1;
+        }
+    }
+
+    // the values carried by the dual numbers must have the same bits of the interpreter
+    auto const differentiated = brun::expr::evaluate(expr, *argv[2], brun::expr::dual<>::variable(value));
+    if (std::bit_cast<std::uint64_t>(differentiated.value) != std::bit_cast<std::uint64_t>(interpreted)
+        and not (std::isnan(differentiated.value) and std::isnan(interpreted))) {
+        std::cerr << "\ndual: " << differentiated.value << '\n';
+        return 1;
+    }
+
+    // the native code must give the same bits as the interpreter
+    auto const compiled = brun::expr::compiled_expression{std::move(expr), *argv[2]}(value);
+    if (std::bit_cast<std::uint64_t>(compiled) != std::bit_cast<std::uint64_t>(interpreted)
+        and not (std::isnan(compiled) and std::isnan(interpreted))) {
+        std::cerr << "\ncompiled: " << compiled << '\n';
+        return 1;
+    }
 }
@@ -0,0 +1,98 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : jit
+ * @created     : Saturday Oct 24, 2026 11:05:18 CEST
+ * @description : the native code must give the same bits as the interpreter
+ */
+
+#include "check.hpp"
+#include <expression.hpp>
+#include <jit.hpp>
+#include <fmt/format.h>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+auto same(double a, double b) -> bool
+{
+    return std::bit_cast<std::uint64_t>(a) == std::bit_cast<std::uint64_t>(b) or (std::isnan(a) and std::isnan(b));
+}
+
+// a balanced tree of this depth needs a register more than the depth, beyond those of the native code
+auto balanced(int depth, std::string const & leaf = "x") -> std::string  // NOLINT(misc-no-recursion)
+{
+    if (depth == 0) {
+        return leaf;
+    }
+    auto const half = balanced(depth - 1, leaf);
+    return "(" + half + "+1)*(" + half + "-0.5)";
+}
+
+// x·(x + 1·(x + 2·(...))), nested on the right as Horner's form
+auto horner(int depth) -> std::string
+{
+    auto result = std::string{"x"};
+    for (auto i = depth; i > 0; --i) {
+        result = "x+" + std::to_string(i) + "/" + std::to_string(depth) + "*(" + result + ")";
+    }
+    return result;
+}
+
+// sin(cos(sin(...(x)))), each call with the values of the outer sums alive
+auto calls(int depth) -> std::string
+{
+    auto result = std::string{"x"};
+    for (auto i = 0; i < depth; ++i) {
+        result = "x*" + std::to_string(i) + "+" + (i % 2 == 0 ? "sin(" : "cos(") + result + ")";
+    }
+    return result;
+}
+}  // namespace
+
+int main()
+{
+    auto const formulas = std::vector<std::string>{
+        "x^2 - 3*x + 1",
+        "-x + x * (-2)",
+        "sin(x) * cos(2*x) + exp(-x^2)",
+        "atan(x)^2 + sqrt(abs(x)) - cbrt(x)",
+        "ln(abs(x) + 1) / (1 + x^2) - log(x)",
+        "tan(x) + asin(x / 4) * acos(x / 4)",
+        "(x % 2) + (x^3 % 3) - ((x + 10) % 7) * 0.5",
+        "x^x^0.5 + 2^x - x^(-1)",
+        "(x + 1) * (x + 2) * (x + 3) * sin((x + 4) * (x + 5) * exp((x + 6) / (x + 7)))",
+        horner(40),
+        calls(12),
+        balanced(6),
+        balanced(12),  // all the registers
+        balanced(8, "sin(x)"),  // calls with most of the registers to spill
+        balanced(14),  // too many registers: the interpreter
+    };
+
+    auto values = std::vector<double>{};
+    for (auto i = -18; i <= 18; ++i) {  // not a multiple of four, to cover the remainder of the batches
+        values.push_back(i * 0.25);
+    }
+    values.insert(values.end(), {1e300, -1e-300, INFINITY, NAN});
+
+    for (auto const & formula : formulas) {
+        auto const interpreted = brun::expr::expression{formula, "x"};
+        auto const compiled = brun::expr::compiled_expression{brun::expr::expression{formula, "x"}, 'x'};
+        auto batch = std::vector<double>(values.size());
+        compiled(values, batch);
+        for (auto i = 0uz; i < values.size(); ++i) {
+            auto const expected = interpreted.eval(brun::expr::parameter{'x', values[i]});
+            auto const scalar = compiled(values[i]);
+            test::check(same(scalar, expected) and same(batch[i], expected), fmt::format(
+                "{} at {}: interpreted {}, scalar {}, batch {}", formula.substr(0, 80), values[i], expected, scalar, batch[i]
+            ));
+        }
+        fmt::print("{}{}: {}\n", compiled.native() ? "native" : "interpreted", compiled.vectorized() ? ", vectorized" : "",
+            formula.substr(0, 80));
+    }
+    return test::result();
+}
@@ -0,0 +1,103 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : shape_file
+ * @created     : Sunday Oct 25, 2026 11:04:52 CET
+ * @description : the points read from text and binary shape files
+ */
+
+#include "check.hpp"
+#include <shape_file.hpp>
+#include <fmt/format.h>
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+using test::check;
+using point = math::vector<double, 2>;
+
+auto const directory = std::filesystem::temp_directory_path();
+
+auto write_file(std::string_view name, std::string_view content) -> std::filesystem::path
+{
+    auto const path = directory / name;
+    std::ofstream{path, std::ios::binary} << content;
+    return path;
+}
+
+// the y axis of the files points upwards, the one of the simulation downwards
+void check_points(std::string_view what, std::filesystem::path const & path, std::vector<point> const & expected)
+{
+    auto const points = sym::read_points(path);
+    if (not points) {
+        check(false, fmt::format("{}: {}", what, points.error()));
+        return;
+    }
+    check(points->size() == expected.size(), fmt::format("{}: {} points", what, points->size()));
+    for (auto i = 0uz; i < std::min(points->size(), expected.size()); ++i) {
+        check((*points)[i][0] == expected[i][0] and (*points)[i][1] == -expected[i][1],
+            fmt::format("{}: point {} is ({}, {})", what, i, (*points)[i][0], (*points)[i][1]));
+    }
+}
+
+void check_error(std::string_view what, std::filesystem::path const & path, std::string_view message)
+{
+    auto const points = sym::read_points(path);
+    check(not points.has_value(), fmt::format("{}: no error", what));
+    if (not points) {
+        check(points.error().contains(message), fmt::format("{}: error '{}'", what, points.error()));
+    }
+}
+
+void text_files()
+{
+    check_points("csv with a header and CRLF", write_file("ropes_shape_test.csv",
+        "x,y\r\n"
+        "0,0\r\n"
+        "1.5,-2\r\n"
+        "# a comment\r\n"
+        "\r\n"
+        "3;4.25;extra column\r\n"
+    ), {{0., 0.}, {1.5, -2.}, {3., 4.25}});
+    check_points("blank separated", write_file("ropes_shape_test.txt", "  0 0\n1\t1e-3\n-2   7\n"),
+        {{0., 0.}, {1., 1e-3}, {-2., 7.}});
+    check_error("bad line", write_file("ropes_shape_test.csv", "0,0\n1,abc\n2,2\n"),
+        "line 2: expected two numbers, found '1,abc'");
+    check_error("single point", write_file("ropes_shape_test.csv", "x,y\n1,2\n"), "at least two points");
+    check_error("missing file", directory / "ropes_shape_test_missing.csv", "ropes_shape_test_missing.csv");
+}
+
+void binary_files()
+{
+    // little endian f64 pairs
+    auto const bytes = [](std::vector<double> const & values) {
+        auto result = std::string{};
+        for (auto const value : values) {
+            auto const bits = std::bit_cast<std::uint64_t>(value);
+            for (auto byte = 0U; byte < 8U; ++byte) {
+                result.push_back(static_cast<char>((bits >> (8U * byte)) & 0xffU));
+            }
+        }
+        return result;
+    };
+    check_points("binary", write_file("ropes_shape_test.bin", bytes({0., 0., 0.5, -1., 2., 3.})),
+        {{0., 0.}, {0.5, -1.}, {2., 3.}});
+    auto const truncated = bytes({0., 0., 0.5, -1., 2.});
+    check_error("truncated binary", write_file("ropes_shape_test.raw", truncated), "not a whole number of f64 pairs");
+}
+}  // namespace
+
+int main()
+{
+    text_files();
+    binary_files();
+    for (auto const * const name : {"ropes_shape_test.csv", "ropes_shape_test.txt", "ropes_shape_test.bin", "ropes_shape_test.raw"}) {
+        std::filesystem::remove(directory / name);
+    }
+    return test::result();
+}
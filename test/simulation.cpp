@@ -0,0 +1,369 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : simulation
+ * @created     : Saturday Oct 24, 2026 16:48:27 CEST
+ * @description : regression of the steps of the simulation against reference values
+ */
+
+#include "check.hpp"
+#include <simulation.hpp>
+#include <equilibrium.hpp>
+#include <ensemble.hpp>
+#include <parareal.hpp>
+#include <calibration.hpp>
+#include <trajectory.hpp>
+#include <fmt/format.h>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+using test::check;
+
+auto make_settings(int points) -> sym::settings
+{
+    return sym::settings{
+        points,
+        100. * ph::N / ph::m,
+        0.01 * ph::GPa,
+        0.5 * ph::N * ph::s / ph::m,
+        2. * ph::N * ph::s / ph::m,
+        (points - 1) * 1. * ph::m,
+        10. * ph::mm,
+        0.2 * ph::kg / ph::m,
+        0.01 * ph::s,
+        60. * ph::Hz,
+        10. * ph::s,
+    };
+}
+
+// three RK4 steps of a rope with a fixed end, all the forces but the bending one
+void rk4_steps()
+{
+    auto settings = make_settings(5);
+    settings.enabled.flexural_rigidity = false;
+    auto const positions = std::array<ph::vector<>, 5>{{{0., 0.}, {1., 0.2}, {1.9, 0.5}, {3., 0.4}, {4.1, 0.9}}};
+    auto const velocities = std::array<ph::vector<>, 5>{{{0., 0.}, {0.3, -0.1}, {-0.2, 0.4}, {0.1, 0.1}, {0.5, -0.3}}};
+    auto rope = sym::memory::vector<ph::state>{};
+    for (auto i = 0uz; i < positions.size(); ++i) {
+        rope.push_back({positions[i] * ph::m, velocities[i] * (ph::m / ph::s), settings.segment_mass, i == 0});
+    }
+
+    for (auto i = 0; i < 3; ++i) {
+        rope = sym::integrate(settings, rope, i * settings.dt, settings.dt).state;
+    }
+
+    // x, y, vx, vy, from an independent implementation of the same forces
+    constexpr auto expected = std::array<std::array<double, 4>, 5>{{
+        {0., 0., 0., 0.},
+        {0.99732524782863874, 0.19862527757551759, -0.25843478195819336, 0.065555042704136535},
+        {1.9242601358887659, 0.51642145044276611, 1.5540514878623646, 0.66144223415726611},
+        {3.0163739047220037, 0.42477571516000112, 0.79808700327720183, 1.3937125150558292},
+        {4.0786085203610503, 0.88003040616591133, -1.6547036304488936, -0.89372809515727836},
+    }};
+    for (auto i = 0uz; i < rope.size(); ++i) {
+        auto const & s = rope[i];
+        auto const & [x, y, vx, vy] = expected[i];
+        check(s.x[0].numerical_value_in(ph::m), x, 1e-12, fmt::format("rk4: x of point {}", i));
+        check(s.x[1].numerical_value_in(ph::m), y, 1e-12, fmt::format("rk4: y of point {}", i));
+        check(s.v[0].numerical_value_in(ph::m / ph::s), vx, 1e-12, fmt::format("rk4: vx of point {}", i));
+        check(s.v[1].numerical_value_in(ph::m / ph::s), vy, 1e-12, fmt::format("rk4: vy of point {}", i));
+    }
+}
+
+// the largest acceleration of the points, in m/s²
+auto largest_acceleration(sym::settings const & settings, std::span<ph::state const> rope) -> double
+{
+    auto segments = std::vector<sym::segment>{};
+    for (auto i = 0uz; i + 1 < rope.size(); ++i) {
+        segments.push_back(sym::segment_forces(settings, rope[i], rope[i + 1]));
+    }
+    auto largest = 0.;
+    for (auto i = 0uz; i < rope.size(); ++i) {
+        auto const * const before = i > 0 ? &segments[i - 1] : nullptr;
+        auto const * const after = i + 1 < rope.size() ? &segments[i] : nullptr;
+        auto const a = sym::acceleration(settings, rope[i], before, after, 0. * ph::s);
+        largest = std::max(largest, std::hypot(
+            a[0].numerical_value_in(ph::m / ph::s2), a[1].numerical_value_in(ph::m / ph::s2)
+        ));
+    }
+    return largest;
+}
+
+// the ropes given by the equilibrium solver must be at rest, with the fixed points in place
+void static_equilibrium()
+{
+    constexpr auto g = 9.80665;
+    auto const settings = make_settings(11);
+    auto const straight = [&](ph::vector<> from, ph::vector<> to, bool last_fixed) {
+        auto rope = std::vector<ph::state>{};
+        for (auto i = 0; i < settings.number_of_points; ++i) {
+            auto const t = i / (settings.number_of_points - 1.);
+            auto const fixed = i == 0 or (last_fixed and i == settings.number_of_points - 1);
+            rope.push_back({(from + (to - from) * t) * ph::m, ph::velocity::zero(), settings.segment_mass, fixed});
+        }
+        return rope;
+    };
+    struct configuration
+    {
+        std::vector<ph::state> rope;
+        std::string_view what;
+    };
+    auto const configurations = std::array{
+        configuration{straight({0., 0.}, {8., 0.}, true), "equilibrium: both ends fixed"},
+        configuration{straight({0., 0.}, {3., -1.}, true), "equilibrium: ends at different heights"},
+        configuration{straight({0., 0.}, {10., 0.}, false), "equilibrium: one end fixed"},
+    };
+    for (auto const & [rope, what] : configurations) {
+        auto const result = sym::static_equilibrium(settings, rope);
+        check(largest_acceleration(settings, result) / g, 0., 1e-6, fmt::format("{}, residual", what));
+        for (auto i = 0uz; i < rope.size(); ++i) {
+            auto const moved = math::norm(result[i].x - rope[i].x).numerical_value_in(ph::m);
+            auto const speed = math::norm(result[i].v).numerical_value_in(ph::m / ph::s);
+            check(speed, 0., 0., fmt::format("{}, speed of point {}", what, i));
+            if (rope[i].fixed) {
+                check(moved, 0., 1e-9, fmt::format("{}, fixed point {} moved", what, i));
+            }
+        }
+    }
+}
+
+// the multirate scheme must follow the single-rate RK4 with the step of its substeps
+void multirate_agreement()
+{
+    auto single_rate = make_settings(11);
+    single_rate.elastic_constant = 1000. * ph::N / ph::m;
+    single_rate.dt = 0.001 * ph::s;
+    auto multirate = single_rate;
+    multirate.substeps = 4;
+    multirate.dt = multirate.substeps * single_rate.dt;
+
+    // a horizontal rope falling from one end
+    auto rope = sym::memory::vector<ph::state>{};
+    for (auto i = 0; i < single_rate.number_of_points; ++i) {
+        rope.push_back({ph::vector<>{1. * i, 0.} * ph::m, ph::velocity::zero(), single_rate.segment_mass, i == 0});
+    }
+    auto single = rope;
+    auto multi = rope;
+    for (auto i = 0; i < 125; ++i) {
+        multi = sym::integrate(multirate, multi, i * multirate.dt, multirate.dt).state;
+        for (auto j = 0; j < multirate.substeps; ++j) {
+            auto const t = i * multirate.dt + j * single_rate.dt;
+            single = sym::integrate(single_rate, single, t, single_rate.dt).state;
+        }
+    }
+
+    // after 0.5 s the free end has moved by more than a metre; the kicks of the soft forces are
+    // first order in the time-step, and differ by about 0.4 mm
+    auto difference = 0.;
+    auto displacement = 0.;
+    for (auto i = 0uz; i < rope.size(); ++i) {
+        difference = std::max(difference, math::norm(multi[i].x - single[i].x).numerical_value_in(ph::m));
+        displacement = std::max(displacement, math::norm(single[i].x - rope[i].x).numerical_value_in(ph::m));
+    }
+    check(displacement > 1., fmt::format("multirate: the rope moved by {} m only", displacement));
+    check(difference, 0., 2e-3, "multirate: distance from the single-rate integration");
+}
+
+// the bending force on the middle of three points, against the one of the circle through them
+void bending_force()
+{
+    auto settings = make_settings(3);
+    settings.enabled = {
+        .gravity = false, .elastic = false, .external_damping = false, .internal_damping = false,
+        .flexural_rigidity = true
+    };
+    auto const force = [&](ph::vector<> a, ph::vector<> b, ph::vector<> c) {
+        auto const point = [&](ph::vector<> x) { return ph::state{x * ph::m, ph::velocity::zero(), settings.segment_mass}; };
+        auto const middle = point(b);
+        auto const before = sym::segment_forces(settings, point(a), middle);
+        auto const after = sym::segment_forces(settings, middle, point(c));
+        auto metadata = ph::metadata{};
+        std::ignore = sym::acceleration(settings, middle, &before, &after, 0. * ph::s, &metadata);
+        return std::array{
+            metadata.bending_stiffness[0].numerical_value_in(ph::N),
+            metadata.bending_stiffness[1].numerical_value_in(ph::N)
+        };
+    };
+
+    struct reference
+    {
+        ph::vector<> a, b, c;
+        std::array<double, 2> expected;  // EI / R · 2 / (|Δx1| + |Δx2|) towards the centre of the circle
+        double tolerance;
+        std::string_view what;
+    };
+    auto const references = std::array{
+        reference{
+            {0., 0.}, {1., 0.}, {1. + std::cos(0.3), std::sin(0.3)},
+            {-0.00021924149632269367, 0.0014506314222415652}, 1e-12, "bending: equal segments"
+        },
+        reference{
+            {0., 0.}, {1., 0.}, {1. + std::cos(0.3), -std::sin(0.3)},
+            {-0.00021924149632269367, -0.0014506314222415652}, 1e-12, "bending: equal segments, mirrored"
+        },
+        reference{
+            {0., 0.}, {0.6, 0.8}, {1.6, 0.8},
+            {0.0019634954084936204, -0.0039269908169872409}, 1e-12, "bending: equal segments, wide angle"
+        },
+        reference{
+            {0., 0.}, {1., 0.}, {1. + 1.1 * std::cos(0.1), 1.1 * std::sin(0.1)},
+            {-2.3302380134257576e-05, 0.00044443983512731017}, 1e-2, "bending: different segments"
+        },
+        reference{{0., 0.}, {1., 0.}, {2., 0.}, {0., 0.}, 0., "bending: aligned points"},
+    };
+    for (auto const & [a, b, c, expected, tolerance, what] : references) {
+        auto const [fx, fy] = force(a, b, c);
+        // relative to the norm of the force, not to each component
+        auto const scale = std::max(std::hypot(expected[0], expected[1]), 1e-300);
+        check(fx / scale, expected[0] / scale, tolerance, fmt::format("{}, x", what));
+        check(fy / scale, expected[1] / scale, tolerance, fmt::format("{}, y", what));
+    }
+}
+
+// each lane of the ensemble must follow the rope integrated alone, with its own constants and masses
+void ensemble_agreement()
+{
+    auto const n_ropes = 6uz;  // the second block has two lanes replicating the last rope
+    auto settings = std::vector<sym::settings>{};
+    auto ropes = std::vector<std::vector<ph::state>>{};
+    for (auto r = 0uz; r < n_ropes; ++r) {
+        auto s = make_settings(12);
+        s.elastic_constant = (100. + 150. * static_cast<double>(r)) * ph::N / ph::m;
+        s.external_damping = 0.1 * static_cast<double>(r) * ph::N * ph::s / ph::m;
+        s.enabled.gravity = r != 3;
+        s.enabled.flexural_rigidity = r % 2 == 0;
+        auto rope = std::vector<ph::state>{};
+        for (auto i = 0; i < s.number_of_points; ++i) {
+            // a heavier point every third one
+            auto const mass = s.segment_mass * (i % 3 == 2 ? 2.5 : 1.);
+            auto const sag = 0.05 * static_cast<double>(r) * std::sin(0.7 * i);
+            rope.push_back({ph::vector<>{1. * i, sag} * ph::m, ph::velocity::zero(), mass, i == 0});
+        }
+        settings.push_back(s);
+        ropes.push_back(rope);
+    }
+
+    auto ensemble = sym::ensemble{settings, ropes};
+    auto sequential = std::vector<sym::memory::vector<ph::state>>{};
+    for (auto const & rope : ropes) {
+        sequential.emplace_back(rope.begin(), rope.end());
+    }
+    auto const dt = 0.001 * ph::s;
+    for (auto i = 0; i < 200; ++i) {
+        ensemble.step(dt);
+        for (auto r = 0uz; r < n_ropes; ++r) {
+            sequential[r] = sym::integrate(settings[r], sequential[r], i * dt, dt).state;
+        }
+    }
+
+    for (auto r = 0uz; r < n_ropes; ++r) {
+        auto const lane = ensemble.rope(r);
+        auto difference = 0.;
+        for (auto i = 0uz; i < lane.size(); ++i) {
+            difference = std::max(difference, math::norm(lane[i].x - sequential[r][i].x).numerical_value_in(ph::m));
+            difference = std::max(difference, math::norm(lane[i].v - sequential[r][i].v).numerical_value_in(ph::m / ph::s));
+            check(lane[i].m == sequential[r][i].m, fmt::format("ensemble: mass of point {} of rope {}", i, r));
+        }
+        check(difference, 0., 1e-9, fmt::format("ensemble: distance of rope {} from the sequential integration", r));
+    }
+
+    // not checked, the speed depends on the machine
+    auto const many = std::vector(256, ropes.front());
+    auto many_ensemble = sym::ensemble{std::vector(many.size(), settings.front()), many};
+    auto const steps = 50;
+    auto const begin = std::chrono::steady_clock::now();
+    for (auto i = 0; i < steps; ++i) {
+        many_ensemble.step(dt);
+    }
+    auto const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    auto const point_steps = static_cast<double>(many.size() * many.front().size()) * steps;
+    fmt::print("ensemble: {} ropes of {} points, {:.1f} M point-steps/s\n", many.size(), many.front().size(),
+        point_steps / elapsed * 1e-6);
+}
+
+// Parareal must converge to the states of the sequential integration at the boundaries of the slices
+void parareal_convergence()
+{
+    auto settings = make_settings(11);
+    settings.dt = 1. / 128 * ph::s;  // the slices are made of whole steps, at the same times
+    auto rope = std::vector<ph::state>{};
+    for (auto i = 0; i < settings.number_of_points; ++i) {
+        rope.push_back({ph::vector<>{1. * i, 0.} * ph::m, ph::velocity::zero(), settings.segment_mass, i == 0});
+    }
+
+    auto const slices = 8;
+    auto const result = sym::parareal(settings, rope, 0. * ph::s, 1. * ph::s, {.slices = slices, .tolerance = 1e-9 * ph::m});
+    check(result.converged, fmt::format("parareal: not converged after {} iterations", result.iterations));
+    check(result.boundaries.size() == slices + 1uz, fmt::format("parareal: {} boundaries", result.boundaries.size()));
+
+    auto sequential = sym::memory::vector<ph::state>(rope.begin(), rope.end());
+    auto const steps_per_slice = 16;
+    for (auto n = 0uz; n < result.boundaries.size(); ++n) {
+        auto difference = 0.;
+        for (auto i = 0uz; i < rope.size(); ++i) {
+            difference = std::max(difference, math::norm(result.boundaries[n][i].x - sequential[i].x).numerical_value_in(ph::m));
+        }
+        check(difference, 0., 1e-6, fmt::format("parareal: distance from the sequential integration at slice {}", n));
+        check(result.times[n].numerical_value_in(ph::s), n / 8., 0., fmt::format("parareal: time of slice {}", n));
+        for (auto j = 0; j < steps_per_slice and n + 1 < result.boundaries.size(); ++j) {
+            auto const step = static_cast<int>(n) * steps_per_slice + j;
+            sequential = sym::integrate(settings, sequential, step * settings.dt, settings.dt).state;
+        }
+    }
+}
+
+// the calibration must find the elastic constant of a recorded rope
+void calibration_recovers_k()
+{
+    auto const truth = make_settings(11);
+    auto const path = std::filesystem::temp_directory_path() / "ropes_calibration_test.ropt";
+    {
+        // the first two frames are close, so that their difference gives the initial velocities
+        auto writer = sym::trajectory_writer{path, {.error_bound = 1e-12 * ph::m}};
+        auto const initial = sym::initial_rope(truth);
+        auto rope = sym::memory::vector<ph::state>(initial.begin(), initial.end());
+        auto t = 0. * ph::s;
+        writer.record(t, rope);
+        auto const first_step = 1e-6 * ph::s;
+        rope = sym::integrate(truth, rope, t, first_step).state;
+        t += first_step;
+        writer.record(t, rope);
+        for (auto frame = 0; frame < 20; ++frame) {
+            for (auto i = 0; i < 5; ++i) {
+                rope = sym::integrate(truth, rope, t, truth.dt).state;
+                t += truth.dt;
+            }
+            writer.record(t, rope);
+        }
+    }
+
+    auto guess = truth;
+    guess.elastic_constant = 150. * ph::N / ph::m;
+    auto reference = sym::trajectory_reader{path};
+    auto const result = sym::calibrate(guess, reference, {.parameters = sym::calibration_options::elastic_constant});
+    std::filesystem::remove(path);
+
+    auto const k = result.settings.elastic_constant.numerical_value_in(ph::N / ph::m);
+    check(k, truth.elastic_constant.numerical_value_in(ph::N / ph::m), 1e-2, "calibration: elastic constant");
+    check(result.loss.numerical_value_in(ph::m), 0., 1e-4, "calibration: loss");
+}
+}  // namespace
+
+int main()
+{
+    rk4_steps();
+    static_equilibrium();
+    multirate_agreement();
+    bending_force();
+    ensemble_agreement();
+    parareal_convergence();
+    calibration_recovers_k();
+    return test::result();
+}
@@ -0,0 +1,130 @@
+/**
+ * @author      : rbrugo (brugo.riccardo@gmail.com)
+ * @file        : trajectory
+ * @created     : Sunday Oct 25, 2026 10:12:37 CET
+ * @description : round trip of the rope positions through a trajectory file
+ */
+
+#include "check.hpp"
+#include <trajectory.hpp>
+#include <fmt/format.h>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+using test::check;
+
+constexpr auto frames = 160uz;
+constexpr auto keyframe_interval = 16;
+constexpr auto error_bound = 1e-4;
+
+// a wave along the rope; the rope loses some points from frame 100, which makes it a keyframe
+auto rope_at(std::size_t frame) -> std::vector<ph::state>
+{
+    auto const points = frame < 100 ? 40 : 25;
+    auto const t = 0.02 * static_cast<double>(frame);
+    auto rope = std::vector<ph::state>{};
+    for (auto i = 0; i < points; ++i) {
+        auto const s = 0.25 * i;
+        rope.push_back({
+            ph::vector<>{s + 0.1 * std::sin(3 * t + s), 0.4 * s * s + 0.3 * std::cos(2 * t - s)} * ph::m,
+            ph::velocity::zero(), 1. * ph::kg
+        });
+    }
+    return rope;
+}
+
+void check_frame(sym::trajectory_reader & reader, std::size_t frame)
+{
+    auto const expected = rope_at(frame);
+    auto const positions = reader.positions(frame);
+    check(positions.size() == expected.size(), fmt::format("frame {}: {} points", frame, positions.size()));
+    check(reader.time(frame).numerical_value_in(ph::s), 0.02 * static_cast<double>(frame), 0.,
+        fmt::format("frame {}: time", frame));
+    auto largest = 0.;
+    for (auto i = 0uz; i < std::min(positions.size(), expected.size()); ++i) {
+        for (auto c = 0uz; c < 2; ++c) {
+            auto const error = positions[i][c] - expected[i].x[c];
+            largest = std::max(largest, std::abs(error.numerical_value_in(ph::m)));
+        }
+    }
+    check(largest <= error_bound * (1 + 1e-9), fmt::format("frame {}: error {} beyond the bound", frame, largest));
+}
+
+// the positions read back are within the error bound, in order and seeking around the keyframes
+void round_trip(std::filesystem::path const & path)
+{
+    {
+        auto writer = sym::trajectory_writer{path, {error_bound * ph::m, keyframe_interval}};
+        for (auto frame = 0uz; frame < frames; ++frame) {
+            writer.record(0.02 * static_cast<double>(frame) * ph::s, rope_at(frame));
+        }
+        writer.flush();
+        check(writer.frames() == frames, "trajectory: frames written");
+        check(writer.compressed_bytes() < writer.raw_bytes(), "trajectory: the frames are not compressed");
+    }
+
+    auto reader = sym::trajectory_reader{path};
+    check(reader.size() == frames, fmt::format("trajectory: {} frames read", reader.size()));
+    check(reader.error_bound().numerical_value_in(ph::m), error_bound, 1e-15, "trajectory: error bound");
+    for (auto frame = 0uz; frame < reader.size(); ++frame) {
+        check_frame(reader, frame);
+    }
+    // keyframes at multiples of 16 and at 100, where the number of points changes
+    for (auto const frame : {150uz, 144uz, 143uz, 100uz, 99uz, 101uz, 17uz, 16uz, 15uz, 0uz, 159uz, 31uz}) {
+        check_frame(reader, frame);
+    }
+
+    auto out_of_range = false;
+    try {
+        std::ignore = reader.positions(frames);
+    } catch (std::out_of_range const &) {
+        out_of_range = true;
+    }
+    check(out_of_range, "trajectory: no error reading past the last frame");
+}
+
+void errors(std::filesystem::path const & path)
+{
+    auto invalid_bound = false;
+    try {
+        sym::trajectory_writer{path, {0. * ph::m}};
+    } catch (std::invalid_argument const &) {
+        invalid_bound = true;
+    }
+    check(invalid_bound, "trajectory: no error with a zero error bound");
+
+    auto unwritable = false;
+    try {
+        sym::trajectory_writer{path / "missing" / "file.ropt", {}};
+    } catch (std::system_error const &) {
+        unwritable = true;
+    }
+    check(unwritable, "trajectory: no error writing in a missing directory");
+
+    std::ofstream{path} << "not a trajectory";
+    auto not_trajectory = false;
+    try {
+        sym::trajectory_reader{path};
+    } catch (std::runtime_error const &) {
+        not_trajectory = true;
+    }
+    check(not_trajectory, "trajectory: no error reading a text file");
+}
+}  // namespace
+
+int main()
+{
+    auto const path = std::filesystem::temp_directory_path() / "ropes_trajectory_test.ropt";
+    round_trip(path);
+    errors(path);
+    std::filesystem::remove(path);
+    return test::result();
+}